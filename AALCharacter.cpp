@@ -1,48 +1,76 @@
 #include "AALCharacter.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Components/ALCharacterMovementComponent.h"
+#include "Components/ALCameraRigComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Camera/CameraComponent.h"
 #include "Components/MeshComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "ALPlayerState.h"
-#include "GameFramework/GameStateBase.h"
-#include "Abilities/ALAbilityData.h"
-#include "Components/ALExplosionComponent.h"
-#include "Components/ALPushAbilityComponent.h"
 #include "Components/ALFireProjectileAbilityComponent.h"
 #include "DrawDebugHelpers.h"
 #include "Components/StaticMeshComponent.h"
 #include "LogMacros.h"
-#include "Components/SphereComponent.h"
 #include "Engine/Engine.h"
-#include "Components/ALSlipperyOil.h"
 #include "Kismet/KismetMathLibrary.h"
-
-
-AALCharacter::AALCharacter(const class FObjectInitializer& ObjectInitializer) :Super(ObjectInitializer)
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "ALStats.h"
+#include "ALProjectilePool.h"
+#include "ALPushSubsystem.h"
+#include "ALAssetStreamingSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_ALCharacterTick, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("MoveForward"), STAT_ALCharacterMoveForward, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("MoveRight"), STAT_ALCharacterMoveRight, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("TurnAtRate"), STAT_ALCharacterTurnAtRate, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleLookHorizontal"), STAT_ALCharacterLookHorizontal, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleLookVertical"), STAT_ALCharacterLookVertical, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleCameraZoomIn"), STAT_ALCharacterCameraZoomIn, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleCameraZoomOut"), STAT_ALCharacterCameraZoomOut, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleSprintPressed"), STAT_ALCharacterSprintPressed, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleSprintReleased"), STAT_ALCharacterSprintReleased, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleJump"), STAT_ALCharacterJump, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("ProcessInputStage"), STAT_ALCharacterInputStage, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleSneakPressed"), STAT_ALCharacterSneakPressed, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleSneakReleased"), STAT_ALCharacterSneakReleased, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleAimPressed"), STAT_ALCharacterAimPressed, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("HandleAimReleased"), STAT_ALCharacterAimReleased, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("Push"), STAT_ALCharacterPush, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("ActivateAbility"), STAT_ALCharacterActivateAbility, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("ApplyCamerShake"), STAT_ALCharacterCameraShake, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("ApplyCamerFOV"), STAT_ALCharacterCameraFOV, STATGROUP_ALCharacter);
+
+
+AALCharacter::AALCharacter(const class FObjectInitializer& ObjectInitializer) :Super(ObjectInitializer.SetDefaultSubobjectClass<UALCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
+	// Everything in Tick either reads the floor the movement component just found or is cosmetic, so it runs after physics
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
 
 	SpringArm = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArm"));
 	SpringArmAim = CreateDefaultSubobject<USpringArmComponent>(TEXT("AimSpringArm"));
 	PlayerCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("Camera"));
-	SphereCollision = CreateDefaultSubobject<USphereComponent>(TEXT("OverlapCollider"));
+	CameraRig = CreateDefaultSubobject<UALCameraRigComponent>(TEXT("CameraRig"));
+	SurfaceHazard = CreateDefaultSubobject<UALSurfaceHazardComponent>(TEXT("SurfaceHazard"));
 
 	//HealthComponent = CreateDefaultSubobject<UALHealthComponent>(TEXT("Health Component"));
 
-	SphereCollision->SetCollisionProfileName("Trigger");
-	SphereCollision->InitSphereRadius(20.f);
-	SphereCollision->SetupAttachment(RootComponent);
-
-	SphereCollision->bHiddenInGame = false;
-	SphereCollision->OnComponentBeginOverlap.AddDynamic(this, &AALCharacter::BeginOverlap);
+	SurfaceHazard->OnSurfaceEntered.AddDynamic(this, &AALCharacter::HandleSurfaceEntered);
 
 	bUseControllerRotationPitch = false;
 	bUseControllerRotationYaw = false;
 	bUseControllerRotationRoll = false;
 
+	ALMovement = CastChecked<UALCharacterMovementComponent>(GetCharacterMovement());
+
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 	GetCharacterMovement()->RotationRate = FRotator(0.f, 540.f, 0.f);
 	GetCharacterMovement()->AirControl = 0.5;
@@ -61,7 +89,7 @@ AALCharacter::AALCharacter(const class FObjectInitializer& ObjectInitializer) :S
 	PlayerCamera->SetupAttachment(SpringArm, USpringArmComponent::SocketName);
 	PlayerCamera->bUsePawnControlRotation = false;
 
-	AutoPossessPlayer = EAutoReceiveInput::Player0;
+	CameraRig->SetupRig(SpringArm, SpringArmAim);
 
 	ShootRotation = UKismetMathLibrary::MakeRotFromX(PlayerCamera->GetForwardVector());
 	CharDashDir = UKismetMathLibrary::MakeRotFromX(PlayerCamera->GetForwardVector());
@@ -70,85 +98,451 @@ AALCharacter::AALCharacter(const class FObjectInitializer& ObjectInitializer) :S
 	JumpCounter = 0.f;
 	MaxJumpCounter = 1.f;
 	LaunchVelocity = 500.f;
-	CameraZoomAmmount = 20.f;
 	DashVelocity = 10000.f;
 	CharDashCounter = 0;
 	CharDashMaxCounter = 1;
+
+	DashKick.FOVOffset = 10.f;
+	DashKick.Duration = 0.35f;
+	ImpactKick.ShakeAmplitude = 1.5f;
+	ImpactKick.Duration = 0.25f;
+}
+
+void AALCharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Level actors in the editor and preview actors never begin play, so they neither load the archetype nor get ability components
+	if (GetWorld() == nullptr || !GetWorld()->IsGameWorld())
+		return;
+
+	// Usually preloaded, in which case the slots are built right here, before SetupPlayerInputComponent binds their actions
+	if (UALAssetStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UALAssetStreamingSubsystem>())
+	{
+		Streaming->RequestArchetype(GetClass(), EALStreamingPriority::Spawn, FSimpleDelegate::CreateUObject(this, &AALCharacter::HandleArchetypeLoaded));
+	}
+	else
+	{
+		AbilitySet.LoadSynchronous();
+		HandleArchetypeLoaded();
+	}
+}
+
+void AALCharacter::HandleArchetypeLoaded()
+{
+	if (IsArchetypeLoaded)
+		return;
+
+	IsArchetypeLoaded = true;
+
+	if (AbilitySet.IsNull())
+		AbilitySlots.BuildLegacy(this);
+	else
+		AbilitySlots.Build(this, AbilitySet.Get());
+
+	// Streamed in after the player input was set up or after BeginPlay, both of which skipped these
+	if (InputComponent)
+		BindAbilityInputs(InputComponent);
+
+	if (HasActorBegunPlay())
+		PrewarmProjectilePool();
+}
+
+void AALCharacter::GatherPreloadAssets(TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Add(AbilitySet.ToSoftObjectPath());
+	OutPaths.Add(PooledProjectileClass.ToSoftObjectPath());
+
+	if (const UALAbilitySet* LoadedAbilitySet = AbilitySet.Get())
+	{
+		for (const FALAbilitySlotDefinition& Slot : LoadedAbilitySet->Slots)
+			OutPaths.Add(Slot.ComponentClass.ToSoftObjectPath());
+	}
 }
 
 void AALCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	InitialWalkSpeed = GetCharacterMovement()->MaxWalkSpeed;
-	PlayerState = CastChecked<AALPlayerState>(GetWorld()->GetGameState()->PlayerArray[0]);
+	ResolvePlayerState();
 
-	ProjectileAbility = Cast<UALFireProjectileAbilityComponent>(GetComponentByClass(UALFireProjectileAbilityComponent::StaticClass()));
-	PushAbility = Cast<UALPushAbilityComponent>(GetComponentByClass(UALPushAbilityComponent::StaticClass()));
-	
+	UALTelemetrySubsystem* TelemetrySubsystem = GetWorld()->GetSubsystem<UALTelemetrySubsystem>();
+	Telemetry = TelemetrySubsystem && TelemetrySubsystem->IsRecording() ? TelemetrySubsystem : nullptr;
+
+	// Other players' characters on clients are never possessed there. The owning client switches back in PawnClientRestart.
+	if (GetLocalRole() == ROLE_SimulatedProxy)
+		SetProxyMode(true);
+
+	if (UALSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UALSignificanceSubsystem>())
+		SignificanceSubsystem->RegisterCharacter(this);
+
+	if (IsArchetypeLoaded)
+		PrewarmProjectilePool();
+}
+
+void AALCharacter::PrewarmProjectilePool()
+{
+	UClass* ProjectileClass = PooledProjectileClass.Get();
+	if (ProjectileClass == nullptr)
+		return;
+
+	// The pool is per class, so only the first character of the class spawns anything here
+	if (UALProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UALProjectilePoolSubsystem>())
+		ProjectilePool->Prewarm(ProjectileClass, ProjectilePoolSize);
+}
+
+bool AALCharacter::FirePooledProjectile()
+{
+	UClass* ProjectileClass = PooledProjectileClass.Get();
+	UALProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UALProjectilePoolSubsystem>();
+	if (ProjectileClass == nullptr || ProjectilePool == nullptr)
+		return false;
+
+	const FRotator AimRotation = GetControlRotation();
+	const FVector Location = GetActorLocation() + AimRotation.RotateVector(ProjectileSpawnOffset);
+
+	// Projectiles hand themselves back with UALProjectilePoolSubsystem::ReleaseOrDestroy, or the pool takes them back when their life span runs out
+	ProjectilePool->AcquireActor(ProjectileClass, FTransform(AimRotation, Location), this, this);
+	return true;
+}
+
+void AALCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	SetProxyMode(!NewController->IsLocalPlayerController());
+
+	// A player is waiting on this one, so it goes ahead of everything still queued
+	if (!IsArchetypeLoaded)
+	{
+		if (UALAssetStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UALAssetStreamingSubsystem>())
+			Streaming->RequestArchetype(GetClass(), EALStreamingPriority::Possession);
+	}
+
+	ResolvePlayerState();
+}
+
+void AALCharacter::PawnClientRestart()
+{
+	// The owning client, before Super sets up the player input
+	SetProxyMode(false);
+
+	Super::PawnClientRestart();
+}
+
+void AALCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+
+	ResolvePlayerState();
+}
+
+void AALCharacter::OnRep_PlayerState()
+{
+	Super::OnRep_PlayerState();
+
+	ResolvePlayerState();
+}
+
+void AALCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owning client predicts these itself
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_SimulatedOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AALCharacter, CosmeticMovementState, Params);
+}
+
+void AALCharacter::UpdateCosmeticMovementState()
+{
+	if (GetLocalRole() != ROLE_Authority)
+		return;
+
+	FALCosmeticMovementState State;
+
+	auto SetFlag = [&State](EALCosmeticFlags Flag, bool Value)
+	{
+		if (Value)
+			State.Flags |= Flag;
+	};
+
+	SetFlag(EALCosmeticFlags::OnOil, IsOnOil);
+	SetFlag(EALCosmeticFlags::Sprinting, IsSprinting);
+	SetFlag(EALCosmeticFlags::Dashing, IsDashing);
+	SetFlag(EALCosmeticFlags::Jumping, IsJumping);
+	SetFlag(EALCosmeticFlags::DoubleJumping, IsDoubleJumping);
+	State.JumpCount = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(JumpCounter), 0, 255));
+
+	if (State == CosmeticMovementState)
+		return;
+
+	CosmeticMovementState = State;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AALCharacter, CosmeticMovementState, this);
+	INC_DWORD_STAT(STAT_ALCosmeticStateDirty);
+}
+
+void AALCharacter::OnRep_CosmeticMovementState(const FALCosmeticMovementState& OldState)
+{
+	const FALCosmeticMovementState& State = CosmeticMovementState;
 
-	//RadioActiveAbility = Cast<UALRadioactiveAbilityComponent>(GetComponentByClass(UALRadioactiveAbilityComponent::StaticClass()));
-	//MicrophoneAbility = Cast<UALMicrophoneAbilityComponent>(GetComponentByClass(UALMicrophoneAbilityComponent::StaticClass()));
+	IsOnOil = State.HasFlag(EALCosmeticFlags::OnOil);
+	JumpCounter = State.JumpCount;
+
+	if (State.HasFlag(EALCosmeticFlags::Sprinting) != OldState.HasFlag(EALCosmeticFlags::Sprinting))
+		ApplySprinting(State.HasFlag(EALCosmeticFlags::Sprinting));
+
+	auto Entered = [&State, &OldState](EALCosmeticFlags Flag)
+	{
+		return State.HasFlag(Flag) && !OldState.HasFlag(Flag);
+	};
+
+	// Landing isn't in here, the proxy's own movement simulation already lands it
+	if (Entered(EALCosmeticFlags::Dashing))
+	{
+		SetMovementState(EALMovementState::Dashing);
+		PostMovementEvent(EALMovementEvent::Dash);
+	}
+	else if (Entered(EALCosmeticFlags::DoubleJumping))
+	{
+		SetMovementState(EALMovementState::DoubleJumping);
+		PostMovementEvent(EALMovementEvent::DoubleJump);
+	}
+	else if (Entered(EALCosmeticFlags::Jumping))
+	{
+		SetMovementState(EALMovementState::Jumping);
+		PostMovementEvent(EALMovementEvent::Jump);
+	}
+
+	// Picks up gliding on and off oil
+	RefreshGroundedState();
+}
+
+void AALCharacter::ResolvePlayerState()
+{
+	// Whichever player owns this character, which is null for AI and before possession has replicated
+	PlayerState = Cast<AALPlayerState>(GetPlayerState());
+}
+
+void AALCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// The recorder writes its file when destroyed, a replay that's still running is reported as aborted
+	if (InputReplayer.IsValid())
+		InputReplayer->Abort(TEXT("the character was destroyed"));
+	InputRecorder.Reset();
+	InputReplayer.Reset();
+
+	if (UALSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UALSignificanceSubsystem>())
+		SignificanceSubsystem->UnregisterCharacter(this);
+
+	if (UALStatusEffectSubsystem* StatusEffects = GetWorld()->GetSubsystem<UALStatusEffectSubsystem>())
+		StatusEffects->RemoveAllEffects(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AALCharacter::OnAcquiredFromPool()
+{
+	// Everything else BeginPlay looked up is still valid from the character's last life
+	if (UALSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UALSignificanceSubsystem>())
+		SignificanceSubsystem->RegisterCharacter(this);
+}
+
+void AALCharacter::OnReturnedToPool()
+{
+	if (UALSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UALSignificanceSubsystem>())
+		SignificanceSubsystem->UnregisterCharacter(this);
+
+	// Nobody looks through a pooled character. Possession picks the mode again.
+	SetProxyMode(true);
+	ResetForReuse();
+}
+
+void AALCharacter::ResetForReuse()
+{
+	SurfaceHazard->ClearFloor();
+
+	if (UALStatusEffectSubsystem* StatusEffects = GetWorld()->GetSubsystem<UALStatusEffectSubsystem>())
+		StatusEffects->RemoveAllEffects(this);
+	SlowEffect = FALStatusEffectHandle();
+
+	ALMovement->ResetForReuse();
+	ResetJumpState();
+
+	IsOnOil = false;
+	OilTime = 0.f;
+	IsSprinting = false;
+	IsSneaking = false;
+	IsAiming = false;
+	IsAbsorbing = false;
+	StartAbsorbing = false;
+	IsCallingOut = false;
+	IsAirborne = false;
+	JumpCounter = 0.f;
+	CharDashCounter = 0.f;
+
+	// Set directly, nobody should get slide or landing events from a reset
+	MovementState = EALMovementState::Grounded;
+	IsJumping = false;
+	IsDoubleJumping = false;
+	IsDashing = false;
+
+	MoveInput.Reset();
+	TurnRateInput = 0.f;
+	BufferedJump.Consume();
+	BufferedDash.Consume();
+	TimeSinceLeftGround = -1.f;
+
+	// The recorder writes its file when destroyed. The next local player sets up its own in SetupPlayerInputComponent.
+	if (InputReplayer.IsValid())
+		InputReplayer->Abort(TEXT("the character was returned to the pool"));
+	InputRecorder.Reset();
+	InputReplayer.Reset();
+
+	AnimSnapshot = FALAnimSnapshot();
+	MovementEvents.DiscardPendingEvents();
+	HeldSprintEvent = EALMovementEvent::Count;
+	HeldSlideEvent = EALMovementEvent::Count;
+	UpdateCosmeticMovementState();
+
+	SetPresentationOffset(FVector::ZeroVector);
+	CameraRig->ResetRig();
+	AbilitySlots.ResetAbilities();
+
+	// Widgets and other actors bound these to the character's last life. The character's own graph and components keep theirs,
+	// since BeginPlay won't run again to bind them.
+	FMulticastScriptDelegate* const Delegates[] = { &OnAbsorbingRequest, &OnAbsorbingSuccessRequest, &OnAbsorbingFailureRequest,
+		&OnJump, &BPOnDoubleJump, &BPOnSprint, &BPOnStopSprint, &BPOnDash, &BPOnSlide, &BPOnStopSlide, &BPOnLanding };
+
+	for (FMulticastScriptDelegate* Delegate : Delegates)
+	{
+		for (UObject* Object : Delegate->GetAllObjects())
+		{
+			if (Object != this && !Object->IsIn(this))
+				Delegate->RemoveAll(Object);
+		}
+	}
 }
 
 void AALCharacter::Tick(float DeltaSeconds)
 { 
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterTick);
+
+#if STATS
+	const double StartTime = FPlatformTime::Seconds();
+#endif
+
 	Super::Tick(DeltaSeconds);
 
-	if (IsOnOil)
+	if (UALSignificanceSubsystem::GetSettings(Significance).CosmeticEvents)
+		MovementEvents.Flush([this](EALMovementEvent Event) { BroadcastBlueprintMovementEvent(Event); });
+	else
+		MovementEvents.Flush([this](EALMovementEvent Event) { HoldBackMovementEvent(Event); });
+
+#if STATS
+	if (Significance == EALSignificance::Critical || Significance == EALSignificance::High)
+	{
+		if (UALSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UALSignificanceSubsystem>())
+			SignificanceSubsystem->ReportTickCost(FPlatformTime::Seconds() - StartTime);
+	}
+#endif
+}
+
+void AALCharacter::SetSignificance(EALSignificance NewSignificance)
+{
+	if (Significance == NewSignificance)
+		return;
+
+	Significance = NewSignificance;
+
+	const FALSignificanceSettings& Settings = UALSignificanceSubsystem::GetSettings(NewSignificance);
+
+	if (Settings.CosmeticEvents)
+		ReleaseHeldMovementEvents();
+
+	// The actor tick keeps the surface under the character up to date, which movement speed depends on. Both are gameplay on the authority.
+	const bool IsThrottled = GetLocalRole() != ROLE_Authority;
+	SetActorTickInterval(IsThrottled ? Settings.ActorTickInterval : 0.f);
+	GetCharacterMovement()->SetComponentTickInterval(IsThrottled ? Settings.MovementTickInterval : 0.f);
+
+	// The camera rig and its arm only matter on the character the camera is looking through
+	if (!IsProxy)
 	{
-		Timer += DeltaSeconds;
-		if (Timer >= OilTimer)
+		CameraRig->SetComponentTickEnabled(Settings.CameraProbing);
+		SpringArm->SetComponentTickEnabled(Settings.CameraProbing);
+	}
+}
+
+void AALCharacter::SetProxyMode(bool NewIsProxy)
+{
+	if (IsProxy == NewIsProxy)
+		return;
+
+	IsProxy = NewIsProxy;
+
+	// The camera stays attached to its arm, so detaching the arms from the root is enough to stop the transform updates
+	USceneComponent* const Arms[] = { SpringArm, SpringArmAim };
+	UActorComponent* const CameraStack[] = { SpringArm, SpringArmAim, PlayerCamera, CameraRig };
+
+	if (IsProxy)
+	{
+		for (UActorComponent* Component : CameraStack)
 		{
-			IsOnOil = false;
-			Timer = 0;
+			// Already registered on a deferred spawn as well, SpawnActorDeferred registers components before FinishSpawning.
+			// Turning off auto register keeps RegisterAllComponents from bringing them back when the actor is reregistered.
+			Component->bAutoRegister = false;
+			if (Component->IsRegistered())
+				Component->UnregisterComponent();
 		}
-	}
 
-	if (IsSprinting)
-		BPOnSprint.Broadcast();
-	if (!IsSprinting)
-		BPOnStopSprint.Broadcast();
+		for (USceneComponent* Arm : Arms)
+			Arm->DetachFromComponent(FDetachmentTransformRules::KeepRelativeTransform);
+
+		CameraKick.Reset();
+		return;
+	}
 
-	Slideing();
+	for (USceneComponent* Arm : Arms)
+		Arm->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
 
-	// Could be more made effective and easily managed by checking for a collision event instead of the collision itself with the ground object. Effectively 
-	// that would mean a cheaper check in terms of cpu cycles as well as easier readability for future development. It would also open up the
-	// possibility to use other checks in the future if the game design allowed it and not just ground collision.
-	if (GetCharacterMovement()->IsMovingOnGround() == true)
+	for (UActorComponent* Component : CameraStack)
 	{
-		JumpCounter = 0;
-		IsJumping = false;
-		IsDoubleJumping = false;
-		IsDashing = false;
+		Component->bAutoRegister = true;
+
+		// Components registered after BeginPlay get their own BeginPlay straight away
+		if (!Component->IsRegistered() && RootComponent->IsRegistered())
+			Component->RegisterComponent();
 	}
 
-	// Same as above. If done with a general collision check instead of checking if the character is moving on the ground these lines could've been applied
-	// to that same check and would've saved up on CPU cycles as well as grouped every collision check together for easier readability.
-	if ((GetCharacterMovement()->IsMovingOnGround() == true) && CharDashCounter >= CharDashMaxCounter)
-		CharDashCounter = 0;
+	const FALSignificanceSettings& Settings = UALSignificanceSubsystem::GetSettings(Significance);
+	CameraRig->SetComponentTickEnabled(Settings.CameraProbing);
+	SpringArm->SetComponentTickEnabled(Settings.CameraProbing);
 }
 
 void AALCharacter::SetupPlayerInputComponent(UInputComponent* InputComponent)
 {
 	Super::SetupPlayerInputComponent(InputComponent);
 
-	InputComponent->BindAxis("MoveForward", this, &AALCharacter::MoveForward);
-	InputComponent->BindAxis("MoveRight", this, &AALCharacter::MoveRight);
-	InputComponent->BindAxis("LookHorizontal", this, &AALCharacter::HandleLookHorizontal);
-	InputComponent->BindAxis("LookVertical", this, &AALCharacter::HandleLookVertical);
-	InputComponent->BindAxis("TurnRate", this, &AALCharacter::TurnAtRate);
-
-	InputComponent->BindAction("Jump", IE_Pressed, this, &AALCharacter::HandleJump);
-	InputComponent->BindAction("Jump", IE_Pressed, this, &AALCharacter::HandleDoubleJump);
-	InputComponent->BindAction("Sprint", IE_Pressed, this, &AALCharacter::HandleSprintPressed);
-	InputComponent->BindAction("Sprint", IE_Released, this, &AALCharacter::HandleSprintReleased);
-	InputComponent->BindAction("ZoomIn", IE_Pressed, this, &AALCharacter::HandleCameraZoomIn);
-	InputComponent->BindAction("ZoomOut", IE_Released, this, &AALCharacter::HandleCameraZoomOut);
-	InputComponent->BindAction("Sneak", IE_Pressed, this, &AALCharacter::HandleSneakPressed);
-	InputComponent->BindAction("Sneak", IE_Released, this, &AALCharacter::HandleSneakReleased);
-
-	InputComponent->BindAction("Projectile", IE_Pressed, this, &AALCharacter::HandleFireProjectile);
+	// Everything goes through HandleBoundInputAxis/Action so it can be recorded, or ignored while a recording is replayed
+	BindInputAxis(InputComponent, "MoveForward", EALInputAxis::MoveForward);
+	BindInputAxis(InputComponent, "MoveRight", EALInputAxis::MoveRight);
+	BindInputAxis(InputComponent, "LookHorizontal", EALInputAxis::LookHorizontal);
+	BindInputAxis(InputComponent, "LookVertical", EALInputAxis::LookVertical);
+	BindInputAxis(InputComponent, "TurnRate", EALInputAxis::TurnRate);
+
+	InputComponent->BindAction<FALInputActionDelegate>("Jump", IE_Pressed, this, &AALCharacter::HandleBoundInputAction, EALInputAction::Jump);
+	InputComponent->BindAction<FALInputActionDelegate>("Sprint", IE_Pressed, this, &AALCharacter::HandleBoundInputAction, EALInputAction::SprintPressed);
+	InputComponent->BindAction<FALInputActionDelegate>("Sprint", IE_Released, this, &AALCharacter::HandleBoundInputAction, EALInputAction::SprintReleased);
+	InputComponent->BindAction<FALInputActionDelegate>("ZoomIn", IE_Pressed, this, &AALCharacter::HandleBoundInputAction, EALInputAction::ZoomIn);
+	InputComponent->BindAction<FALInputActionDelegate>("ZoomOut", IE_Released, this, &AALCharacter::HandleBoundInputAction, EALInputAction::ZoomOut);
+	InputComponent->BindAction<FALInputActionDelegate>("Sneak", IE_Pressed, this, &AALCharacter::HandleBoundInputAction, EALInputAction::SneakPressed);
+	InputComponent->BindAction<FALInputActionDelegate>("Sneak", IE_Released, this, &AALCharacter::HandleBoundInputAction, EALInputAction::SneakReleased);
+
+	// Otherwise bound by HandleArchetypeLoaded
+	AreAbilityInputsBound = false;
+	if (IsArchetypeLoaded)
+		BindAbilityInputs(InputComponent);
 
 	// ---------
 	// Should've been removed since it's not in use of the final version. Cleaning the code is important to avoid misstakes when revisiting
@@ -161,222 +555,758 @@ void AALCharacter::SetupPlayerInputComponent(UInputComponent* InputComponent)
 	// ---------
 	
 	// TEST aim
-	InputComponent->BindAction("Aim", IE_Pressed, this, &AALCharacter::HandleAimPressed);
-	InputComponent->BindAction("Aim", IE_Released, this, &AALCharacter::HandleAimReleased);
+	InputComponent->BindAction<FALInputActionDelegate>("Aim", IE_Pressed, this, &AALCharacter::HandleBoundInputAction, EALInputAction::AimPressed);
+	InputComponent->BindAction<FALInputActionDelegate>("Aim", IE_Released, this, &AALCharacter::HandleBoundInputAction, EALInputAction::AimReleased);
 
 	// TEST FirePush
-	InputComponent->BindAction("FirePush", IE_Pressed, this, &AALCharacter::HandlePush);
+	InputComponent->BindAction<FALInputActionDelegate>("FirePush", IE_Pressed, this, &AALCharacter::HandleBoundInputAction, EALInputAction::FirePush);
+
+	// Runs again on every possession. An existing recorder keeps recording, restarting it would truncate its file.
+	if (InputRecorder.IsValid() || InputReplayer.IsValid())
+		return;
+
+	FString InputFilename;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ALReplayInput="), InputFilename))
+	{
+		InputReplayer = MakeUnique<FALInputReplayer>(this, InputFilename);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("ALRecordInput="), InputFilename))
+	{
+		// Respawned and pooled characters get a new recorder, which writes to Name_1.ext, Name_2.ext and so on
+		UALTelemetrySubsystem* TelemetrySubsystem = GetWorld()->GetSubsystem<UALTelemetrySubsystem>();
+		const int32 RecordingIndex = TelemetrySubsystem ? TelemetrySubsystem->NextInputRecordingIndex() : 0;
+		if (RecordingIndex > 0)
+			InputFilename = FPaths::GetBaseFilename(InputFilename, false) + FString::Printf(TEXT("_%d"), RecordingIndex) + FPaths::GetExtension(InputFilename, true);
+
+		InputRecorder = MakeUnique<FALInputRecorder>(InputFilename);
+	}
+}
+
+void AALCharacter::BindAbilityInputs(UInputComponent* PlayerInputComponent)
+{
+	if (AreAbilityInputsBound)
+		return;
+
+	// Characters set up before ability sets keep the projectile binding they had
+	if (AbilitySet.IsNull())
+	{
+		UE_LOG(LogALCharacter, Warning, TEXT("%s has no ability set, binding the Projectile action to its own projectile ability"), *GetClass()->GetName());
+
+		AreAbilityInputsBound = true;
+		PlayerInputComponent->BindAction<FALInputActionDelegate>("Projectile", IE_Pressed, this, &AALCharacter::HandleBoundInputAction, EALInputAction::FireProjectile);
+		return;
+	}
+
+	const UALAbilitySet* LoadedAbilitySet = AbilitySet.Get();
+	if (LoadedAbilitySet == nullptr)
+		return;
+
+	AreAbilityInputsBound = true;
+
+	const int32 NumSlots = FMath::Min(LoadedAbilitySet->Slots.Num(), UALAbilitySet::MaxSlots);
+	for (int32 Slot = 0; Slot < NumSlots; Slot++)
+	{
+		const EALInputAction Action = static_cast<EALInputAction>(static_cast<int32>(EALInputAction::AbilitySlot0) + Slot);
+		PlayerInputComponent->BindAction<FALInputActionDelegate>(LoadedAbilitySet->Slots[Slot].InputActionName, IE_Pressed, this, &AALCharacter::HandleBoundInputAction, Action);
+	}
+}
+
+void AALCharacter::BindInputAxis(UInputComponent* InputComponent, FName AxisName, EALInputAxis Axis)
+{
+	FInputAxisBinding Binding(AxisName);
+	Binding.AxisDelegate.GetDelegateForManualSet().BindUObject(this, &AALCharacter::HandleBoundInputAxis, Axis);
+	InputComponent->AxisBindings.Add(Binding);
+}
+
+void AALCharacter::HandleBoundInputAction(EALInputAction Action)
+{
+	if (InputReplayer.IsValid() && InputReplayer->IsReplaying())
+		return;
+
+	if (InputRecorder.IsValid())
+		InputRecorder->RecordAction(Action);
+
+	DispatchInputAction(Action);
+}
+
+void AALCharacter::HandleBoundInputAxis(float Val, EALInputAxis Axis)
+{
+	if (InputReplayer.IsValid() && InputReplayer->IsReplaying())
+		return;
+
+	if (InputRecorder.IsValid())
+		InputRecorder->RecordAxis(Axis, Val);
+
+	DispatchInputAxis(Val, Axis);
+}
+
+void AALCharacter::DispatchInputAction(EALInputAction Action)
+{
+	if (Action >= EALInputAction::AbilitySlot0 && Action <= EALInputAction::AbilitySlotLast)
+	{
+		ActivateAbilitySlot(static_cast<int32>(Action) - static_cast<int32>(EALInputAction::AbilitySlot0));
+		return;
+	}
+
+	switch (Action)
+	{
+	case EALInputAction::Jump:
+		HandleJump();
+		break;
+	case EALInputAction::SprintPressed:
+		HandleSprintPressed();
+		break;
+	case EALInputAction::SprintReleased:
+		HandleSprintReleased();
+		break;
+	case EALInputAction::ZoomIn:
+		HandleCameraZoomIn();
+		break;
+	case EALInputAction::ZoomOut:
+		HandleCameraZoomOut();
+		break;
+	case EALInputAction::SneakPressed:
+		HandleSneakPressed();
+		break;
+	case EALInputAction::SneakReleased:
+		HandleSneakReleased();
+		break;
+	case EALInputAction::AimPressed:
+		HandleAimPressed();
+		break;
+	case EALInputAction::AimReleased:
+		HandleAimReleased();
+		break;
+	case EALInputAction::FirePush:
+		HandlePush();
+		break;
+	case EALInputAction::FireProjectile:
+		HandleFireProjectile();
+		break;
+	default:
+		break;
+	}
+}
+
+void AALCharacter::DispatchInputAxis(float Val, EALInputAxis Axis)
+{
+	switch (Axis)
+	{
+	case EALInputAxis::MoveForward:
+		MoveForward(Val);
+		break;
+	case EALInputAxis::MoveRight:
+		MoveRight(Val);
+		break;
+	case EALInputAxis::LookHorizontal:
+		HandleLookHorizontal(Val);
+		break;
+	case EALInputAxis::LookVertical:
+		HandleLookVertical(Val);
+		break;
+	case EALInputAxis::TurnRate:
+		TurnAtRate(Val);
+		break;
+	default:
+		break;
+	}
+}
+
+void AALCharacter::Landed(const FHitResult& Hit)
+{
+	Super::Landed(Hit);
+
+	EnterGrounded();
+}
+
+void AALCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	if (GetCharacterMovement()->IsFalling())
+	{
+		IsAirborne = true;
+
+		// Walked off a ledge instead of jumping or dashing off it
+		if (MovementState == EALMovementState::Grounded || MovementState == EALMovementState::Sneaking || MovementState == EALMovementState::Gliding)
+		{
+			SetMovementState(EALMovementState::Falling);
+			TimeSinceLeftGround = 0.f;
+		}
+	}
+	// Landed() isn't called when the mode is set directly (spawning, teleporting), so the ground is picked up here as well.
+	else if (GetCharacterMovement()->IsMovingOnGround())
+		EnterGrounded();
+}
+
+void AALCharacter::SetMovementState(EALMovementState NewState)
+{
+	if (MovementState == NewState)
+		return;
+
+	const EALMovementState OldState = MovementState;
+	MovementState = NewState;
+
+	if (OldState == EALMovementState::Gliding)
+		PostMovementEvent(EALMovementEvent::SlideStop);
+	else if (NewState == EALMovementState::Gliding)
+		PostMovementEvent(EALMovementEvent::SlideStart);
+
+	// The old flags are still read by the AnimBP, so they follow the state instead of being set by hand.
+	switch (NewState)
+	{
+	case EALMovementState::Grounded:
+	case EALMovementState::Sneaking:
+	case EALMovementState::Gliding:
+		IsJumping = false;
+		IsDoubleJumping = false;
+		IsDashing = false;
+		break;
+	case EALMovementState::Jumping:
+		IsJumping = true;
+		break;
+	case EALMovementState::DoubleJumping:
+		IsDoubleJumping = true;
+		break;
+	case EALMovementState::Dashing:
+		IsDashing = true;
+		break;
+	default:
+		break;
+	}
+}
+
+void AALCharacter::RefreshGroundedState()
+{
+	if (IsAirborne)
+		return;
+
+	if (IsOnOil && IsSprinting)
+		SetMovementState(EALMovementState::Gliding);
+	else if (IsSneaking)
+		SetMovementState(EALMovementState::Sneaking);
+	else
+		SetMovementState(EALMovementState::Grounded);
+}
+
+void AALCharacter::PostMovementEvent(EALMovementEvent Event)
+{
+	// Moves replayed after a server correction have already sent their events once
+	if (GetCharacterMovement()->bClientUpdating)
+		return;
+
+	MovementEvents.Post(Event);
+
+	switch (Event)
+	{
+	case EALMovementEvent::Jump:
+		RecordTelemetry(EALTelemetryEvent::Jump);
+		break;
+	case EALMovementEvent::DoubleJump:
+		RecordTelemetry(EALTelemetryEvent::DoubleJump);
+		break;
+	case EALMovementEvent::Dash:
+		RecordTelemetry(EALTelemetryEvent::Dash);
+		break;
+	case EALMovementEvent::SlideStart:
+		RecordTelemetry(EALTelemetryEvent::SlideStart);
+		break;
+	case EALMovementEvent::SlideStop:
+		RecordTelemetry(EALTelemetryEvent::SlideStop);
+		break;
+	default:
+		break;
+	}
+}
+
+void AALCharacter::EnterGrounded()
+{
+	// Both Landed and OnMovementModeChanged end up here for the same landing
+	if (!IsAirborne)
+		return;
+
+	IsAirborne = false;
+	ALMovementRules::ResetOnLanding(JumpCounter, CharDashCounter);
+
+	RefreshGroundedState();
+	PostMovementEvent(EALMovementEvent::Landing);
+}
+
+void AALCharacter::HoldBackMovementEvent(EALMovementEvent Event)
+{
+	switch (Event)
+	{
+	// Only the latest of each pair matters, the Blueprint just has to end up in the right state
+	case EALMovementEvent::SprintStart:
+	case EALMovementEvent::SprintStop:
+		HeldSprintEvent = Event;
+		break;
+	case EALMovementEvent::SlideStart:
+	case EALMovementEvent::SlideStop:
+		HeldSlideEvent = Event;
+		break;
+	// Ends whatever the jump or dash effects were doing, so it's never held back
+	case EALMovementEvent::Landing:
+		BroadcastBlueprintMovementEvent(Event);
+		break;
+	// One-shots are stale by the time the character matters again
+	default:
+		break;
+	}
+}
+
+void AALCharacter::ReleaseHeldMovementEvents()
+{
+	if (HeldSprintEvent != EALMovementEvent::Count)
+		BroadcastBlueprintMovementEvent(HeldSprintEvent);
+	if (HeldSlideEvent != EALMovementEvent::Count)
+		BroadcastBlueprintMovementEvent(HeldSlideEvent);
+
+	HeldSprintEvent = EALMovementEvent::Count;
+	HeldSlideEvent = EALMovementEvent::Count;
+}
+
+void AALCharacter::BroadcastBlueprintMovementEvent(EALMovementEvent Event)
+{
+	INC_DWORD_STAT(STAT_ALBlueprintBroadcasts);
+
+	switch (Event)
+	{
+	case EALMovementEvent::SprintStart:
+		BPOnSprint.Broadcast();
+		break;
+	case EALMovementEvent::SprintStop:
+		BPOnStopSprint.Broadcast();
+		break;
+	case EALMovementEvent::SlideStart:
+		BPOnSlide.Broadcast();
+		break;
+	case EALMovementEvent::SlideStop:
+		BPOnStopSlide.Broadcast();
+		break;
+	case EALMovementEvent::Dash:
+		BPOnDash.Broadcast();
+		break;
+	case EALMovementEvent::Jump:
+		OnJump.Broadcast();
+		break;
+	case EALMovementEvent::DoubleJump:
+		BPOnDoubleJump.Broadcast();
+		break;
+	case EALMovementEvent::Landing:
+		BPOnLanding.Broadcast();
+		break;
+	default:
+		break;
+	}
 }
 
 void AALCharacter::ApplyCamerShake()
 {
-	// A variable for the ammount of CameraFOV would've been good in case a menu option for it would've been planned in the future. It's
-	// something that some people can experience as a initiator for motion sickness as they play games and an option for the ammount or any at all
-	// would've been forward thinking with the player in mind. 
-	if (CamerShake != nullptr)
-		GetWorld()->GetFirstPlayerController()->PlayerCameraManager->PlayCameraShake(CamerShake, 1.0f);
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterCameraShake);
+
+	if (UALCameraKickModifier* Kick = GetCameraKick())
+		Kick->AddKick(ImpactKick);
 }
 
 void AALCharacter::ApplyCamerFOV()
 {
-	// A variable for the ammount of CameraFOV would've been good in case a menu option for it would've been planned in the future.
-	// It's an easy quality of life thing that players appreciate and would've been easy to apply to the game. Also it's a good
-	// easy-to-make accessability option for those who easily get motion sickness while playing games.
-	if (CamerFov != nullptr)
-		GetWorld()->GetFirstPlayerController()->PlayerCameraManager->PlayCameraShake(CamerFov, 1.0f);
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterCameraFOV);
+
+	if (UALCameraKickModifier* Kick = GetCameraKick())
+		Kick->AddKick(DashKick);
+}
+
+UALCameraKickModifier* AALCharacter::GetCameraKick()
+{
+	// Only the controller of this character, and only where it has a camera
+	APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	if (PlayerController == nullptr || PlayerController->PlayerCameraManager == nullptr)
+		return nullptr;
+
+	if (CameraKick.IsValid() && CameraKick->CameraOwner == PlayerController->PlayerCameraManager)
+		return CameraKick.Get();
+
+	UCameraModifier* Modifier = PlayerController->PlayerCameraManager->FindCameraModifierByClass(UALCameraKickModifier::StaticClass());
+	if (Modifier == nullptr)
+		Modifier = PlayerController->PlayerCameraManager->AddNewCameraModifier(UALCameraKickModifier::StaticClass());
+
+	CameraKick = Cast<UALCameraKickModifier>(Modifier);
+	if (CameraKick.IsValid())
+		CameraKick->SetStrength(CameraKickStrength);
+
+	return CameraKick.Get();
+}
+
+void AALCharacter::SetCameraKickStrength(float NewStrength)
+{
+	CameraKickStrength = FMath::Max(NewStrength, 0.f);
+
+	if (CameraKick.IsValid())
+		CameraKick->SetStrength(CameraKickStrength);
 }
 
 void AALCharacter::MoveForward(float Val)
 {
-	const FRotator Rotation = Controller->GetControlRotation();
-	const FRotator YawRotation(0, Rotation.Yaw, 0);
-	const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-	AddMovementInput(Direction, Val);
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterMoveForward);
+
+	// Turned into a world direction once per frame in ProcessInputStage, together with MoveRight
+	MoveInput.Forward += Val;
 }
 
 void AALCharacter::MoveRight(float Val)
 {
-	const FRotator Rotation = Controller->GetControlRotation();
-	const FRotator YawRotation(0, Rotation.Yaw, 0);
-	const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
-	
-	if (IsOnOil && IsSprinting)
-		AddMovementInput(Direction, Val / 2);
-	
-	else
-		AddMovementInput(Direction, Val);
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterMoveRight);
+
+	// Steering while gliding is damped by the movement component, using SlideValue
+	MoveInput.Right += Val;
+}
+
+void AALCharacter::ProcessInputStage(float DeltaSeconds)
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterInputStage);
+
+	if (TurnRateInput != 0.f)
+	{
+		AddControllerYawInput(TurnRateInput * BaseTurnRate * DeltaSeconds);
+		TurnRateInput = 0.f;
+	}
+
+	if (!MoveInput.IsZero())
+	{
+		// Without a controller, like right after unpossessing, the character moves relative to where it faces
+		const float Yaw = Controller ? Controller->GetControlRotation().Yaw : GetActorRotation().Yaw;
+		AddMovementInput(MoveInput.ToWorld(Yaw));
+		MoveInput.Reset();
+	}
 
+	const float Now = GetWorld()->GetTimeSeconds();
+	ResolveBufferedJump(Now);
+	ResolveBufferedDash(Now);
 }
 
 void AALCharacter::TurnAtRate(float Rate)
 {
-	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterTurnAtRate);
+
+	// The world's delta isn't the one this character's movement ticks with, so it's scaled in ProcessInputStage instead
+	TurnRateInput += Rate;
+}
+
+void AALCharacter::SetPresentationOffset(const FVector& NewOffset)
+{
+	if (NewOffset.Equals(PresentationOffset))
+		return;
+
+	// The mesh offset is relative to the capsule, the spring arm's target offset is in world space
+	GetMesh()->SetRelativeLocation(GetBaseTranslationOffset() + GetActorTransform().InverseTransformVectorNoScale(NewOffset));
+	SpringArm->TargetOffset += NewOffset - PresentationOffset;
+	PresentationOffset = NewOffset;
 }
 
 void AALCharacter::HandleLookHorizontal(float Val)
 {
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterLookHorizontal);
+
 	AddControllerYawInput(Val);
 }
 
 void AALCharacter::HandleLookVertical(float Val)
 {
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterLookVertical);
+
 	AddControllerPitchInput(Val);
 }
 
-// -----------
-// splitting up the camera settings and functionality from the character into it's own component would've been a good option
-// for keeping the character code clean, but also to split it's own properties from the character since it doesn't exactly have anything to do
-// with the character itself. It also would've been a good option to have a public min and max zoom ammount as floats for the designers to be able
-// to adress/change their values on their own from inside the client itself.
-
 void AALCharacter::HandleCameraZoomIn()
 {
-	if (SpringArm->TargetArmLength > 150.f)
-		SpringArm->TargetArmLength -= CameraZoomAmmount;
-	else
-		SpringArm->TargetArmLength++;
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterCameraZoomIn);
+
+	CameraRig->ZoomIn();
 }
 
 void AALCharacter::HandleCameraZoomOut()
 {
-	if (SpringArm->TargetArmLength < 400.f)
-		SpringArm->TargetArmLength += CameraZoomAmmount;
-	else
-		SpringArm->TargetArmLength--;
-}
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterCameraZoomOut);
 
-// -----------
+	CameraRig->ZoomOut();
+}
 
 void AALCharacter::HandleSprintPressed()
 {
-	IsSprinting = true;
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterSprintPressed);
 
-	if (GetCharacterMovement()->MaxWalkSpeed != SlowSpeed && GetCharacterMovement()->IsMovingOnGround() == true && !IsOnOil)
-		GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
+	// Sprinting and dashing are part of the predicted move. The movement component calls ApplySprinting and PerformDash when it runs it.
+	ALMovement->SetWantsToSprint(true);
 
-	if (GetCharacterMovement()->IsMovingOnGround() == false && CharDashCounter < CharDashMaxCounter && !IsOnOil)
-	{
-		// Should've been removed from the final version in order to keep the code clean for future development
-		
-//		BPApplyDashEffects();
-		LaunchCharacter(PlayerCamera->GetForwardVector() * DashVelocity, false, true);
-		SetActorRotation(CharDashDir);
-		ApplyCamerFOV();
-
-		CharDashCounter++;
-		IsDashing = true;
-		BPOnDash.Broadcast();
-	}
+	// Requested from ProcessInputStage, so a press right before leaving the ground still dashes
+	BufferedDash.Press(GetWorld()->GetTimeSeconds());
 }
 
 void AALCharacter::HandleSprintReleased()
 {
-	IsSprinting = false;
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterSprintReleased);
 
-	if (GetCharacterMovement()->MaxWalkSpeed != SlowSpeed)
-		GetCharacterMovement()->MaxWalkSpeed = InitialWalkSpeed;
+	ALMovement->SetWantsToSprint(false);
 }
 
 void AALCharacter::HandleJump()
 {
-	Jump();
-	if (GetCharacterMovement()->IsMovingOnGround() == true)
-		OnJump.Broadcast();
-	IsJumping = true;
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterJump);
+
+	// Resolved to a jump or a double jump in ProcessInputStage
+	BufferedJump.Press(GetWorld()->GetTimeSeconds());
 }
 
-void AALCharacter::HandleDoubleJump()
+void AALCharacter::ResolveBufferedJump(float Now)
 {
-	// Since the check for ground movement of the character is done here it isn't necessary for it in the tick function and the event can be
-	// broadcasted instead to save up on CPU cycles.
-	if (GetCharacterMovement()->IsMovingOnGround() == false && JumpCounter < MaxJumpCounter)
+	if (!BufferedJump.IsPending(Now, JumpBufferTime))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("double jumped"))
-		LaunchCharacter(FVector(0, 0, 1) * LaunchVelocity, false, true);
-		JumpCounter++;
-		BPOnDoubleJump.Broadcast();
-		IsDoubleJumping = true;
+		BufferedJump.Consume();
+		return;
+	}
+
+	// A single press is either a jump or a double jump, never both. The jump state is entered from OnJumped
+	// once the movement component has actually jumped, and IsAirborne doesn't flip until then either.
+	if (!IsAirborne || IsInCoyoteTime())
+	{
+		Jump();
+		BufferedJump.Consume();
+	}
+	else if (ALMovementRules::CanDoubleJump(IsAirborne, JumpCounter, MaxJumpCounter))
+	{
+		ALMovement->RequestDoubleJump();
+		BufferedJump.Consume();
+	}
+	// Otherwise it stays buffered and jumps on landing
+}
+
+void AALCharacter::ResolveBufferedDash(float Now)
+{
+	if (!BufferedDash.IsPending(Now, DashBufferTime))
+	{
+		BufferedDash.Consume();
+		return;
+	}
+
+	if (ALMovementRules::CanDash(IsAirborne, IsOnOil, CharDashCounter, CharDashMaxCounter))
+	{
+		ALMovement->RequestDash();
+		BufferedDash.Consume();
 	}
 }
 
+void AALCharacter::AdvanceCoyoteTime(float DeltaSeconds)
+{
+	if (TimeSinceLeftGround < 0.f)
+		return;
+
+	TimeSinceLeftGround += DeltaSeconds;
+	if (TimeSinceLeftGround > CoyoteTime)
+		TimeSinceLeftGround = -1.f;
+}
+
+bool AALCharacter::IsInCoyoteTime() const
+{
+	// Only after walking off a ledge, jumping or dashing off the ground doesn't count
+	return IsAirborne && MovementState == EALMovementState::Falling && JumpCounter == 0.f && TimeSinceLeftGround >= 0.f;
+}
+
+bool AALCharacter::CanJumpInternal_Implementation() const
+{
+	// ACharacter counts walking off a ledge as the first jump, which would rule out the coyote jump
+	return Super::CanJumpInternal_Implementation() || IsInCoyoteTime();
+}
+
 void AALCharacter::HandleSneakPressed()
 {
-	IsSneaking = true;
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterSneakPressed);
 
-	if (GetCharacterMovement()->MaxWalkSpeed != SlowSpeed)
-		GetCharacterMovement()->MaxWalkSpeed = SneakSpeed;
+	ALMovement->SetWantsToSneak(true);
 }
 
 void AALCharacter::HandleSneakReleased()
 {
-	IsSneaking = false;
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterSneakReleased);
 
-	if (GetCharacterMovement()->MaxWalkSpeed != SlowSpeed)
-		GetCharacterMovement()->MaxWalkSpeed = InitialWalkSpeed;
+	ALMovement->SetWantsToSneak(false);
 }
 
-void AALCharacter::StartSlow()
+void AALCharacter::ApplySprinting(bool NewIsSprinting)
 {
-	GetCharacterMovement()->MaxWalkSpeed = SlowSpeed;
+	IsSprinting = NewIsSprinting;
+	PostMovementEvent(IsSprinting ? EALMovementEvent::SprintStart : EALMovementEvent::SprintStop);
+
+	RefreshGroundedState();
+}
+
+void AALCharacter::ApplySneaking(bool NewIsSneaking)
+{
+	IsSneaking = NewIsSneaking;
+
+	RefreshGroundedState();
+}
+
+void AALCharacter::PerformDash()
+{
+	// Checked again here, this is where the server validates the client's request
+	if (!ALMovementRules::CanDash(IsAirborne, IsOnOil, CharDashCounter, CharDashMaxCounter))
+		return;
+
+	// The control rotation is part of the move, unlike the camera, so the server dashes the same way the client did
+	ALMovement->StartDash(GetControlRotation().Vector(), DashDistance, DashVelocity);
+	SetActorRotation(CharDashDir);
+
+	CharDashCounter++;
+
+	if (GetCharacterMovement()->bClientUpdating)
+		return;
+
+	if (IsLocallyControlled())
+		ApplyCamerFOV();
+
+	SetMovementState(EALMovementState::Dashing);
+	PostMovementEvent(EALMovementEvent::Dash);
+}
+
+void AALCharacter::PerformDoubleJump()
+{
+	if (!ALMovementRules::CanDoubleJump(IsAirborne, JumpCounter, MaxJumpCounter))
+		return;
+
+	UE_LOG(LogALCharacter, Verbose, TEXT("%s double jumped"), *GetName());
+	LaunchCharacter(FVector(0, 0, 1) * LaunchVelocity, false, true);
+	INC_DWORD_STAT(STAT_ALLaunchCharacterCalls);
+	JumpCounter++;
+
+	if (GetCharacterMovement()->bClientUpdating)
+		return;
+
+	SetMovementState(EALMovementState::DoubleJumping);
+	PostMovementEvent(EALMovementEvent::DoubleJump);
+}
+
+void AALCharacter::OnJumped_Implementation()
+{
+	Super::OnJumped_Implementation();
+
+	if (GetCharacterMovement()->bClientUpdating)
+		return;
+
+	SetMovementState(EALMovementState::Jumping);
+	PostMovementEvent(EALMovementEvent::Jump);
+}
+
+void AALCharacter::StartSlow(float Duration)
+{
+	UALStatusEffectSubsystem* StatusEffects = GetWorld()->GetSubsystem<UALStatusEffectSubsystem>();
+	if (StatusEffects == nullptr)
+		return;
+
+	// Slowing again restarts it with the new duration instead of stacking
+	StatusEffects->RemoveEffect(SlowEffect);
+
+	FALStatusEffectSpec Spec;
+	Spec.Type = EALStatusEffect::Slow;
+	Spec.Duration = Duration;
+	SlowEffect = StatusEffects->ApplyEffect(this, Spec);
 }
 
 void AALCharacter::EndSlow()
 {
-	GetCharacterMovement()->MaxWalkSpeed = InitialWalkSpeed;
+	if (UALStatusEffectSubsystem* StatusEffects = GetWorld()->GetSubsystem<UALStatusEffectSubsystem>())
+		StatusEffects->RemoveEffect(SlowEffect);
+}
+
+void AALCharacter::ApplyStatusEffects(const FALStatusEffectTotals& Totals)
+{
+	ALMovement->SetSpeedModifiers(Totals.AdditiveSpeed, Totals.SpeedMultiplier);
+	ALMovement->SetSlowed(Totals.Has(EALStatusEffect::Slow));
 }
 
 //TEST AIM
 void AALCharacter::HandleAimPressed()
 {
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterAimPressed);
+
 	// Aiming isn't used in the final version of the game and therefor should've been removed in it's entirety 
-	if (IsAiming == false)
-		PlayerCamera->SetupAttachment(SpringArmAim, USpringArmComponent::SocketName);
-		
 	IsAiming = true;
+	CameraRig->SetAiming(true);
 }
 
 //TEST AIM
 void AALCharacter::HandleAimReleased()
 {
-	// Aiming isn't used in the final version of the game and therefor should've been removed in it's entirety 
-	if (IsAiming == true)
-		PlayerCamera->SetupAttachment(SpringArm, USpringArmComponent::SocketName);
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterAimReleased);
 
+	// Aiming isn't used in the final version of the game and therefor should've been removed in it's entirety 
 	IsAiming = false;
+	CameraRig->SetAiming(false);
 }
 
 //TEST PUSH
 void AALCharacter::HandlePush()
 {
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterPush);
+
 	// Pushing isn't present in the final version of the game and therefor shouldn't be in the code of the character. If it were to be used however
 	// it should be it's own component that's applied onto the character instead of being part of it.
-	PushAbility->Push();
+	// The bodies are found and pushed over the next frames, so a push into a big pile doesn't hitch the frame it's pressed in.
+	if (UALPushSubsystem* PushSubsystem = GetWorld()->GetSubsystem<UALPushSubsystem>())
+		PushSubsystem->QueuePush(this, GetActorLocation(), PushRadius, ForceStrength);
+
+	RecordTelemetry(EALTelemetryEvent::Push);
 }
 
-void AALCharacter::BeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
+void AALCharacter::HandleSurfaceEntered(EALSurfaceType SurfaceType)
 {
-	// Overlapping with oil
-	if (OtherActor->GetComponentByClass(UALSlipperyOil::StaticClass()))
-		IsOnOil = true;	
+	if (SurfaceType != EALSurfaceType::Oil)
+		return;
+
+	if (!IsOnOil && !GetCharacterMovement()->bClientUpdating)
+		RecordTelemetry(EALTelemetryEvent::OilEnter);
+
+	IsOnOil = true;
+	OilTime = 0.f;
+	RefreshGroundedState();
 }
 
-void AALCharacter::Slideing()
+void AALCharacter::UpdateMoveSurface(float DeltaSeconds)
 {
-	if (!IsOnOil && IsSprinting)
-		GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
+	// The floor comes from the move, so the client, the server and replayed moves all step on and off oil on the same move
+	if (!IsAirborne)
+		SurfaceHazard->UpdateFloor(GetCharacterMovement()->CurrentFloor);
 
-	if (IsOnOil && IsSprinting)
+	// A replayed move can start from before the character stepped onto the oil it's still on, which isn't reported as entering it
+	if (SurfaceHazard->GetCurrentSurface() == EALSurfaceType::Oil)
 	{
-		GetCharacterMovement()->MaxWalkSpeed = GlidSpeed;
-		BPOnSlide.Broadcast();
+		if (!IsOnOil)
+			HandleSurfaceEntered(EALSurfaceType::Oil);
+		return;
+	}
+
+	// Stays slippery for OilTimer after stepping off, counted in movement time like the crowd agents do
+	if (ALMovementRules::TickOilTimer(IsOnOil, OilTime, OilTimer, DeltaSeconds))
+	{
+		RefreshGroundedState();
+		if (!GetCharacterMovement()->bClientUpdating)
+			RecordTelemetry(EALTelemetryEvent::OilExit);
 	}
+}
 
+void AALCharacter::ActivateAbilitySlot(int32 Slot)
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALCharacterActivateAbility);
+
+	AbilitySlots.Activate(Slot);
 }
 
 void AALCharacter::HandleFireProjectile()
 {
-/*	SetActorRotation(ShootRotation);*/
-	ProjectileAbility->ThrowProjectile();
+	// Also what recordings made before ability sets replay their fire presses as
+	const int32 Slot = AbilitySlots.FindSlot(UALFireProjectileAbilityComponent::StaticClass());
+	if (Slot != INDEX_NONE)
+		ActivateAbilitySlot(Slot);
 }
 
 void AALCharacter::HandleAbsorbAbilityPressed()
@@ -418,3 +1348,53 @@ bool AALCharacter::ReturnIfSprinting()
 {
 	return IsSprinting;
 }
+
+void AALCharacter::PublishAnimSnapshot(float DeltaSeconds)
+{
+	FALAnimSnapshot Snapshot;
+
+	auto SetFlag = [&Snapshot](EALAnimFlags Flag, bool Value)
+	{
+		if (Value)
+			Snapshot.Flags |= Flag;
+	};
+
+	SetFlag(EALAnimFlags::Sprinting, IsSprinting);
+	SetFlag(EALAnimFlags::Sneaking, IsSneaking);
+	SetFlag(EALAnimFlags::Dashing, IsDashing);
+	SetFlag(EALAnimFlags::Jumping, IsJumping);
+	SetFlag(EALAnimFlags::DoubleJumping, IsDoubleJumping);
+	SetFlag(EALAnimFlags::Gliding, IsOnOil && IsSprinting);
+	SetFlag(EALAnimFlags::Running, !IsOnOil && IsSprinting);
+	SetFlag(EALAnimFlags::Airborne, IsAirborne);
+	SetFlag(EALAnimFlags::OnOil, IsOnOil);
+	SetFlag(EALAnimFlags::Aiming, IsAiming);
+
+	const FVector Velocity = GetVelocity();
+	Snapshot.Speed = Velocity.Size();
+	Snapshot.Direction = Snapshot.Speed > KINDA_SMALL_NUMBER ? FRotator::NormalizeAxis(Velocity.Rotation().Yaw - GetActorRotation().Yaw) : 0.f;
+	Snapshot.AirTime = IsAirborne ? AnimSnapshot.AirTime + DeltaSeconds : 0.f;
+
+	AnimSnapshot = Snapshot;
+}
+
+FALMovementRuleState AALCharacter::GetMovementRuleState() const
+{
+	FALMovementRuleState State;
+	State.IsOnOil = IsOnOil;
+	State.OilTime = OilTime;
+
+	State.JumpCounter = JumpCounter;
+	State.DashCounter = CharDashCounter;
+	return State;
+}
+
+void AALCharacter::SetMovementRuleState(const FALMovementRuleState& State)
+{
+	IsOnOil = State.IsOnOil;
+	OilTime = State.OilTime;
+	JumpCounter = State.JumpCounter;
+	CharDashCounter = State.DashCounter;
+
+	RefreshGroundedState();
+}
@@ -2,13 +2,39 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "ALMovementEvents.h"
+#include "ALMovementRules.h"
+#include "ALSignificanceSubsystem.h"
+#include "ALInputReplay.h"
+#include "ALInputStage.h"
+#include "Components/ALSurfaceHazardComponent.h"
+#include "Abilities/ALAbilitySet.h"
+#include "ALCameraKickModifier.h"
+#include "ALAnimSnapshot.h"
+#include "ALCosmeticMovementState.h"
+#include "ALStatusEffectSubsystem.h"
+#include "ALTelemetry.h"
+#include "ALProjectilePool.h"
 #include "AALCharacter.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnAbsoringObject);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FJump);
 
+// Grounded, Sneaking and Gliding are the ground states, the rest are only entered while the movement component is falling.
+UENUM(BlueprintType)
+enum class EALMovementState : uint8
+{
+	Grounded,
+	Sneaking,
+	Gliding,
+	Falling,
+	Jumping,
+	DoubleJumping,
+	Dashing
+};
+
 UCLASS()
-class AALCharacter : public ACharacter
+class AALCharacter : public ACharacter, public IALPoolableActor
 {
 	GENERATED_BODY()
 
@@ -16,9 +42,22 @@ public:
 
 	AALCharacter(const class FObjectInitializer& ObjectInitializer);
 
+	virtual void PostInitializeComponents() override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaSeconds) override;
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent);
+	virtual void Landed(const FHitResult& Hit) override;
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
+	virtual void OnJumped_Implementation() override;
+	virtual bool CanJumpInternal_Implementation() const override;
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
+	virtual void PawnClientRestart() override;
+	virtual void OnRep_PlayerState() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReturnedToPool() override;
 
 public:
 
@@ -34,11 +73,14 @@ public:
 	bool IsDoubleJumping = false;
 	UPROPERTY(BlueprintReadOnly)
 	float JumpCounter;
+	UPROPERTY(BlueprintReadOnly)
+	EALMovementState MovementState = EALMovementState::Grounded;
 
+	// Set on possession on the server and when the player state replicates on clients
 	class AALPlayerState * PlayerState;
 
 	UPROPERTY(VisibleDefaultsOnly)
-	class USphereComponent* SphereCollision;
+	class UALSurfaceHazardComponent* SurfaceHazard;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera", meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* PlayerCamera;
@@ -46,8 +88,8 @@ public:
 	class USpringArmComponent* SpringArm;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
 	class USpringArmComponent* SpringArmAim;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
-	float CameraZoomAmmount;
+	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Camera")
+	class UALCameraRigComponent* CameraRig;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
 	float BaseTurnRate;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
@@ -62,7 +104,7 @@ public:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Sliding")
 	float GlidSpeed = 2000.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Sliding", meta = (ToolTip = "The value divided by 'Move Right Value'.\nMake sure it isn't less then 1"))
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Sliding", meta = (ToolTip = "Steering across the glide is divided by this value.\nMake sure it isn't less then 1"))
 	float SlideValue = 2;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Sliding", meta = (ToolTip = "Timer the player can gilde, while holding down 'sprint/slide' button"))
 	float SlideTimer = 4;
@@ -71,34 +113,59 @@ public:
 	float MaxJumpCounter;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Jumping")
 	float LaunchVelocity;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Dashing")
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Jumping", meta = (ToolTip = "How long a jump pressed in the air is kept, so it still jumps when landing shortly after"))
+	float JumpBufferTime = 0.15f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Jumping", meta = (ToolTip = "How long after walking off a ledge the player can still do a ground jump"))
+	float CoyoteTime = 0.1f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Dashing", meta = (ToolTip = "How long a dash pressed when it can't be done yet is kept, like right before leaving the ground"))
+	float DashBufferTime = 0.1f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Dashing", meta = (ToolTip = "Speed at the start of the dash, which then eases out to a stop"))
 	float DashVelocity;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character Movement: Dashing", meta = (ToolTip = "How far a dash goes unless it hits something"))
+	float DashDistance = 800.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile", meta = (ToolTip = "Projectile the fire ability takes from the projectile pool. Without one the ability spawns its own projectiles"))
+	TSoftClassPtr<AActor> PooledProjectileClass;
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile", meta = (ToolTip = "How many projectiles of this class the pool keeps ready, shared by every character firing it", ClampMin = "0"))
+	int32 ProjectilePoolSize = 32;
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile", meta = (ToolTip = "Where pooled projectiles start, relative to the character and turned with the aim"))
+	FVector ProjectileSpawnOffset = FVector(100.f, 0.f, 50.f);
 
 	// All test functions and variables should've been removed before the build of the final version.
 	/// TEST
 	UPROPERTY(EditDefaultsOnly, Category = "Pushing")
 	float ForceStrength = 10000.f;
+	UPROPERTY(EditDefaultsOnly, Category = "Pushing")
+	float PushRadius = 500.f;
 
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Use IsSprinting on UALAnimInstance instead"))
 	bool ReturnIfSprinting();
 
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Use IsSneaking on UALAnimInstance instead"))
 	bool ReturnIfSneaking();
 
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Use IsDashing on UALAnimInstance instead"))
 	bool ReturnIfDashing();
 
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Use IsJumping on UALAnimInstance instead"))
 	bool ReturnIfJumping();
 
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Use IsDoubleJumping on UALAnimInstance instead"))
 	bool ReturnIfDoubleJumping();
 
 	void CallTakeDamage(int32 Damage,bool IsGuard);
 
-	void StartSlow();
+	// Fires PooledProjectileClass along the control rotation from the projectile pool. Used by the fire ability's slot adapter.
+	// Returns false when the character has no pooled projectile class, so the ability spawns one itself.
+	bool FirePooledProjectile();
+
+	// A duration of 0 or less slows until EndSlow, anything else wears off by itself
+	void StartSlow(float Duration = 0.f);
 	void EndSlow();
 
+	// Called by UALStatusEffectSubsystem once per frame at most, when this character's effects have changed
+	void ApplyStatusEffects(const FALStatusEffectTotals& Totals);
+
 	UPROPERTY(BlueprintAssignable, meta = (ToolTip = "Happens while trying to absorb something"))
 	FOnAbsoringObject OnAbsorbingRequest;
 	UPROPERTY(BlueprintAssignable, meta = (ToolTip = "Happens when successfully absorb an ability"))
@@ -128,6 +195,9 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FJump BPOnSlide;
 
+	UPROPERTY(BlueprintAssignable)
+	FJump BPOnStopSlide;
+
 	UPROPERTY(BLueprintAssignable)
 	FJump BPOnLanding;
 
@@ -135,12 +205,77 @@ public:
 // 	UFUNCTION(BlueprintImplementableEvent, meta = (ToolTip = "Called when the character dash action is performed"))
 // 	void BPApplyDashEffects();
 
-	UFUNCTION(BlueprintCallable, BlueprintPure)
+	// Everything this character only soft references, streamed in by UALAssetStreamingSubsystem. Called on the class default object,
+	// and again once the ability set is loaded to pick up the ability components in it.
+	void GatherPreloadAssets(TArray<FSoftObjectPath>& OutPaths) const;
+
+	// Puts movement state, counters, status effects, abilities, input and camera back to how a freshly spawned character starts,
+	// and drops Blueprint delegate bindings made by anything outside this character. Called by UALCharacterPoolSubsystem on release.
+	void ResetForReuse();
+
+	// Used by UALCrowdSubsystem when an agent is turned into a full character near the player, and back again.
+	FALMovementRuleState GetMovementRuleState() const;
+	void SetMovementRuleState(const FALMovementRuleState& State);
+	float GetOilTimer() const { return OilTimer; }
+	float GetMaxDashCounter() const { return CharDashMaxCounter; }
+
+	// Called by UALCharacterMovementComponent while it runs a move, on the owning client and on the server
+	void ApplySprinting(bool NewIsSprinting);
+	void ApplySneaking(bool NewIsSneaking);
+	void PerformDash();
+	void PerformDoubleJump();
+	void AdvanceCoyoteTime(float DeltaSeconds);
+	void UpdateMoveSurface(float DeltaSeconds);
+
+	// Saved and restored with each move by FSavedMove_AL, so replayed moves see the same coyote time
+	float GetTimeSinceLeftGround() const { return TimeSinceLeftGround; }
+	void SetTimeSinceLeftGround(float NewTime) { TimeSinceLeftGround = NewTime; }
+
+	// Every bound input ends up here, and so does FALInputReplayer
+	void DispatchInputAction(EALInputAction Action);
+	void DispatchInputAxis(float Val, EALInputAxis Axis);
+
+	// Called by the movement component once per frame, right before it consumes the movement input.
+	// Turns the axes collected since the last frame into one movement input and resolves the buffered presses.
+	void ProcessInputStage(float DeltaSeconds);
+
+	// Moves the mesh and camera by Offset without moving the capsule. Used by the movement component to draw the local player
+	// between two dash or glide steps.
+	void SetPresentationOffset(const FVector& NewOffset);
+
+	// Proxies are characters no local player looks through: remote players, simulated proxies and AI. They unregister the camera,
+	// its spring arms and the camera rig, so none of them tick, trace or follow the character's transform. Picked on possession,
+	// or by spawners before FinishSpawning. SpawnActorDeferred has registered the components by then, so a proxy spawn still
+	// registers the camera stack once and unregisters it here; what proxies save is the per-frame cost afterwards.
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void SetProxyMode(bool NewIsProxy);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Camera")
+	bool IsProxyMode() const { return IsProxy; }
+
+	// Called by UALSignificanceSubsystem when the character moves to another significance bucket
+	void SetSignificance(EALSignificance NewSignificance);
+	EALSignificance GetSignificance() const { return Significance; }
+
+	// Native listeners bind here. The Blueprint delegates above only get the same events once per frame.
+	FALMovementEventBus& GetMovementEvents() { return MovementEvents; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, meta = (DeprecatedFunction, DeprecationMessage = "Use IsGliding on UALAnimInstance instead"))
 	bool IsGliding() { return IsOnOil && IsSprinting; }
 
-	UFUNCTION(BlueprintCallable, BlueprintPure)
+	UFUNCTION(BlueprintCallable, BlueprintPure, meta = (DeprecatedFunction, DeprecationMessage = "Use IsRunning on UALAnimInstance instead"))
 	bool IsRunning() { return !IsOnOil && IsSprinting; }
 
+	// Read by UALAnimInstance's proxy. Published by the movement component after each movement update.
+	const FALAnimSnapshot& GetAnimSnapshot() const { return AnimSnapshot; }
+	void PublishAnimSnapshot(float DeltaSeconds);
+
+	// Called by the movement component after each movement update. Only does anything on the server.
+	void UpdateCosmeticMovementState();
+
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void SetCameraKickStrength(float NewStrength);
+
 
 private:
 	// Bunch up the UFUNCTIONs together instead of splitting them up in different parts of the header. Same
@@ -152,16 +287,41 @@ private:
 	UFUNCTION()
 	void ApplyCamerFOV();
 
-	UPROPERTY(EditDefaultsOnly, Category = "Camera")
-	TSubclassOf<class UCameraShake> CamerShake;
+	UPROPERTY(EditDefaultsOnly, Category = "Camera", meta = (ToolTip = "Shake played by ApplyCamerShake, used for impacts"))
+	FALCameraKickParams ImpactKick;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Camera", meta = (ToolTip = "FOV kick played when dashing"))
+	FALCameraKickParams DashKick;
+
+	// Multiplies every camera kick. 0 turns them off, for players who get motion sick.
+	float CameraKickStrength = 1.f;
+
+	FALAnimSnapshot AnimSnapshot;
+
+	// Simulated proxies get the flags above from this instead of replicating each of them
+	UPROPERTY(ReplicatedUsing = OnRep_CosmeticMovementState)
+	FALCosmeticMovementState CosmeticMovementState;
+
+	UFUNCTION()
+	void OnRep_CosmeticMovementState(const FALCosmeticMovementState& OldState);
+
+	TWeakObjectPtr<UALCameraKickModifier> CameraKick;
+	UALCameraKickModifier* GetCameraKick();
+
+	UPROPERTY(EditDefaultsOnly, Category = "Ability", meta = (ToolTip = "The abilities this character has and the input actions that activate them"))
+	TSoftObjectPtr<UALAbilitySet> AbilitySet;
+
+	UPROPERTY(Transient)
+	FALAbilitySlotTable AbilitySlots;
+
+	// Set once UALAssetStreamingSubsystem has this character's class in memory. The ability slots and the projectile pool wait for it.
+	bool IsArchetypeLoaded = false;
+	bool AreAbilityInputsBound = false;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Camera")
-	TSubclassOf<class UCameraShake> CamerFov;
+	void HandleArchetypeLoaded();
+	void BindAbilityInputs(UInputComponent* PlayerInputComponent);
+	void PrewarmProjectilePool();
 
-	class UALFireProjectileAbilityComponent* ProjectileAbility;
-	class UALPushAbilityComponent* PushAbility;
-	//class UALRadioactiveAbilityComponent* RadioActiveAbility;
-	//class UALMicrophoneAbilityComponent* MicrophoneAbility;
 	//class UALHealthComponent* HealthComponent;
 
 	UPROPERTY(EditAnywhere, Category = "Absorb Ability", meta = (ToolTip = "The time the player have to hold down key to get ability"))
@@ -175,12 +335,27 @@ private:
 	bool IsAiming = false;
 	FRotator ShootRotation;
 
-	float InitialWalkSpeed;
-
 	float CharDashCounter;
 	float CharDashMaxCounter;
 	FRotator CharDashDir;
 
+	void BindInputAxis(UInputComponent* InputComponent, FName AxisName, EALInputAxis Axis);
+	void HandleBoundInputAction(EALInputAction Action);
+	void HandleBoundInputAxis(float Val, EALInputAxis Axis);
+
+	TUniquePtr<FALInputRecorder> InputRecorder;
+	TUniquePtr<FALInputReplayer> InputReplayer;
+
+	FALMoveInput MoveInput;
+	// TurnRate axis collected over the frame, applied in ProcessInputStage with the tick's delta
+	float TurnRateInput = 0.f;
+	FALBufferedInput BufferedJump;
+	FALBufferedInput BufferedDash;
+
+	// Movement time since the character walked off the ground, for coyote time. Negative once it's over or when it never started.
+	// Counted from move deltas rather than world time, so the client, the server and replayed moves all agree on it.
+	float TimeSinceLeftGround = -1.f;
+
 	void MoveForward(float Val);
 	void MoveRight(float Val);
 	void TurnAtRate(float Rate);
@@ -191,11 +366,15 @@ private:
 	void HandleSprintPressed();
 	void HandleSprintReleased();
 	void HandleJump();
-	void HandleDoubleJump();
+	void ResolveBufferedJump(float Now);
+	void ResolveBufferedDash(float Now);
+	bool IsInCoyoteTime() const;
 	void HandleSneakPressed();
 	void HandleSneakReleased();
 
+	void ActivateAbilitySlot(int32 Slot);
 	void HandleFireProjectile();
+	void ResolvePlayerState();
 
 	void HandleAbsorbAbilityPressed();
 	void HandleAbsorbAbilityReleased();
@@ -208,16 +387,55 @@ private:
 	void HandlePush();
 
 	UFUNCTION()
-	void BeginOverlap(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-	
-	void Slideing();
+	void HandleSurfaceEntered(EALSurfaceType SurfaceType);
 
-	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Sliding", meta = (ToolTip = "The time player is 'slippery' after walking on oil"))
+	
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Sliding", meta = (ToolTip = "The time player is 'slippery' after walking off oil"))
 	float OilTimer = 1.5f;
 
-	
-	float Timer = 0;
+	// Movement time since stepping off oil. IsOnOil stays set until it reaches OilTimer.
+	float OilTime = 0.f;
+	FALStatusEffectHandle SlowEffect;
 
 	bool IsCallingOut = false;
 
+	// Only changed by OnMovementModeChanged and Landed, so the input handlers never have to ask the movement component about the ground.
+	bool IsAirborne = false;
+
+	void SetMovementState(EALMovementState NewState);
+	void RefreshGroundedState();
+	void EnterGrounded();
+
+	FALMovementEventBus MovementEvents;
+
+	void PostMovementEvent(EALMovementEvent Event);
+
+	// Null when the world isn't recording telemetry
+	UPROPERTY(Transient)
+	UALTelemetrySubsystem* Telemetry;
+
+	FORCEINLINE void RecordTelemetry(EALTelemetryEvent Event)
+	{
+		if (Telemetry)
+			Telemetry->Record(Event, GetUniqueID(), GetActorLocation());
+	}
+
+	UPROPERTY()
+	class UALCharacterMovementComponent* ALMovement;
+
+	EALSignificance Significance = EALSignificance::Critical;
+
+	bool IsProxy = false;
+
+	FVector PresentationOffset = FVector::ZeroVector;
+
+	void BroadcastBlueprintMovementEvent(EALMovementEvent Event);
+
+	// Sprint and slide edges of a character in a bucket without cosmetic events, sent once it's back in one. Count when there's none.
+	EALMovementEvent HeldSprintEvent = EALMovementEvent::Count;
+	EALMovementEvent HeldSlideEvent = EALMovementEvent::Count;
+
+	void HoldBackMovementEvent(EALMovementEvent Event);
+	void ReleaseHeldMovementEvents();
+
 };
@@ -0,0 +1,25 @@
+#include "ALAnimInstance.h"
+#include "AALCharacter.h"
+
+void FALAnimInstanceProxy::Initialize(UAnimInstance* InAnimInstance)
+{
+	FAnimInstanceProxy::Initialize(InAnimInstance);
+
+	Character = Cast<AALCharacter>(InAnimInstance->TryGetPawnOwner());
+}
+
+void FALAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+	// Game thread, before the worker thread update. The only place the character is read.
+	if (Character == nullptr)
+		Character = Cast<AALCharacter>(InAnimInstance->TryGetPawnOwner());
+
+	Snapshot = Character ? Character->GetAnimSnapshot() : FALAnimSnapshot();
+}
+
+FAnimInstanceProxy* UALAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FALAnimInstanceProxy(this);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "ALAnimSnapshot.h"
+#include "ALAnimInstance.generated.h"
+
+class AALCharacter;
+
+USTRUCT()
+struct FALAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FALAnimInstanceProxy() {}
+	FALAnimInstanceProxy(UAnimInstance* InAnimInstance) : FAnimInstanceProxy(InAnimInstance) {}
+
+	virtual void Initialize(UAnimInstance* InAnimInstance) override;
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+
+	FALAnimSnapshot Snapshot;
+
+private:
+
+	const AALCharacter* Character = nullptr;
+};
+
+// Native base for the character's AnimBP. The getters only read the proxy's copy of the character's snapshot, so they're
+// safe to call from the anim graph with multithreaded animation update turned on, and no event graph is needed to gather state.
+UCLASS(Transient, Blueprintable)
+class UALAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsSprinting() const { return GetSnapshot().HasFlag(EALAnimFlags::Sprinting); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsSneaking() const { return GetSnapshot().HasFlag(EALAnimFlags::Sneaking); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsDashing() const { return GetSnapshot().HasFlag(EALAnimFlags::Dashing); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsJumping() const { return GetSnapshot().HasFlag(EALAnimFlags::Jumping); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsDoubleJumping() const { return GetSnapshot().HasFlag(EALAnimFlags::DoubleJumping); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsGliding() const { return GetSnapshot().HasFlag(EALAnimFlags::Gliding); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsRunning() const { return GetSnapshot().HasFlag(EALAnimFlags::Running); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsAirborne() const { return GetSnapshot().HasFlag(EALAnimFlags::Airborne); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsOnOil() const { return GetSnapshot().HasFlag(EALAnimFlags::OnOil); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	bool IsAiming() const { return GetSnapshot().HasFlag(EALAnimFlags::Aiming); }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	float GetSpeed() const { return GetSnapshot().Speed; }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	float GetDirection() const { return GetSnapshot().Direction; }
+
+	UFUNCTION(BlueprintPure, Category = "Animation", meta = (BlueprintThreadSafe))
+	float GetAirTime() const { return GetSnapshot().AirTime; }
+
+protected:
+
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+
+private:
+
+	const FALAnimSnapshot& GetSnapshot() const { return GetProxyOnAnyThread<FALAnimInstanceProxy>().Snapshot; }
+};
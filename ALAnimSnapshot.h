@@ -0,0 +1,43 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ALAnimSnapshot.generated.h"
+
+enum class EALAnimFlags : uint16
+{
+	None = 0,
+	Sprinting = 1 << 0,
+	Sneaking = 1 << 1,
+	Dashing = 1 << 2,
+	Jumping = 1 << 3,
+	DoubleJumping = 1 << 4,
+	Gliding = 1 << 5,
+	Running = 1 << 6,
+	Airborne = 1 << 7,
+	OnOil = 1 << 8,
+	Aiming = 1 << 9
+};
+ENUM_CLASS_FLAGS(EALAnimFlags);
+
+// Everything the animation needs from AALCharacter, written once per frame after movement. It's copied as a whole to the
+// anim instance proxy on the game thread, so the animation update can read it on a worker thread without touching the character.
+USTRUCT(BlueprintType)
+struct FALAnimSnapshot
+{
+	GENERATED_BODY()
+
+	EALAnimFlags Flags = EALAnimFlags::None;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Animation")
+	float Speed = 0.f;
+
+	// Yaw of the velocity relative to the actor, -180 to 180
+	UPROPERTY(BlueprintReadOnly, Category = "Animation")
+	float Direction = 0.f;
+
+	// Seconds since leaving the ground, 0 while grounded
+	UPROPERTY(BlueprintReadOnly, Category = "Animation")
+	float AirTime = 0.f;
+
+	bool HasFlag(EALAnimFlags Flag) const { return EnumHasAnyFlags(Flags, Flag); }
+};
@@ -0,0 +1,208 @@
+#include "ALAssetStreamingSubsystem.h"
+#include "HAL/PlatformTime.h"
+#include "AALCharacter.h"
+#include "ALStats.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogALStreaming, Log, All);
+
+void UALAssetStreamingSubsystem::Deinitialize()
+{
+	for (TPair<TWeakObjectPtr<UClass>, FArchetype>& Pair : Archetypes)
+	{
+		for (const TSharedPtr<FStreamableHandle>& Handle : Pair.Value.Handles)
+		{
+			if (Handle.IsValid() && Handle->IsLoadingInProgress())
+				Handle->CancelHandle();
+		}
+	}
+
+	Archetypes.Reset();
+	Queue.Reset();
+	NumActiveRequests = 0;
+
+	Super::Deinitialize();
+}
+
+bool UALAssetStreamingSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Queue.Num() > 0 && NumActiveRequests < MaxActiveRequests;
+}
+
+TStatId UALAssetStreamingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UALAssetStreamingSubsystem, STATGROUP_Tickables);
+}
+
+void UALAssetStreamingSubsystem::Tick(float DeltaTime)
+{
+	while (Queue.Num() > 0 && NumActiveRequests < MaxActiveRequests)
+	{
+		// Highest priority first, and the oldest request among equals since the queue is in request order
+		int32 Next = INDEX_NONE;
+		for (int32 Index = 0; Index < Queue.Num(); Index++)
+		{
+			const FArchetype* Archetype = Archetypes.Find(Queue[Index]);
+			if (Archetype == nullptr)
+				continue;
+
+			if (Next == INDEX_NONE || Archetype->Priority > Archetypes.FindChecked(Queue[Next]).Priority)
+				Next = Index;
+		}
+
+		if (Next == INDEX_NONE)
+		{
+			Queue.Reset();
+			break;
+		}
+
+		const TWeakObjectPtr<UClass> WeakCharacterClass = Queue[Next];
+		Queue.RemoveAt(Next);
+
+		UClass* CharacterClass = WeakCharacterClass.Get();
+		if (CharacterClass == nullptr)
+		{
+			Archetypes.Remove(WeakCharacterClass);
+			continue;
+		}
+
+		StartRequest(CharacterClass, Archetypes.FindChecked(WeakCharacterClass));
+	}
+}
+
+void UALAssetStreamingSubsystem::RequestArchetype(TSubclassOf<AALCharacter> CharacterClass, EALStreamingPriority Priority, FSimpleDelegate OnLoaded)
+{
+	if (CharacterClass == nullptr)
+		return;
+
+	FArchetype* Archetype = Archetypes.Find(CharacterClass.Get());
+	if (Archetype == nullptr)
+	{
+		Archetype = &Archetypes.Add(CharacterClass.Get());
+		Archetype->Priority = Priority;
+		Archetype->RequestTime = FPlatformTime::Seconds();
+
+		TArray<FSoftObjectPath> Paths;
+		GatherAssets(CharacterClass, Paths, true);
+		if (Paths.Num() == 0)
+			FinishArchetype(CharacterClass, *Archetype);
+		else
+			Queue.Add(CharacterClass.Get());
+	}
+
+	if (Archetype->IsLoaded)
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	// Only moves it up while it's still queued, a running request keeps the priority it was started with
+	Archetype->Priority = FMath::Max(Archetype->Priority, Priority);
+
+	if (OnLoaded.IsBound())
+		Archetype->OnLoaded.Add(OnLoaded);
+}
+
+void UALAssetStreamingSubsystem::PreloadArchetype(TSubclassOf<AALCharacter> CharacterClass)
+{
+	RequestArchetype(CharacterClass, EALStreamingPriority::Background);
+}
+
+bool UALAssetStreamingSubsystem::IsArchetypeLoaded(TSubclassOf<AALCharacter> CharacterClass) const
+{
+	const FArchetype* Archetype = Archetypes.Find(CharacterClass.Get());
+	return Archetype && Archetype->IsLoaded;
+}
+
+double UALAssetStreamingSubsystem::GetArchetypeLoadSeconds(TSubclassOf<AALCharacter> CharacterClass) const
+{
+	const FArchetype* Archetype = Archetypes.Find(CharacterClass.Get());
+	return Archetype ? Archetype->LoadSeconds : 0.0;
+}
+
+void UALAssetStreamingSubsystem::GatherAssets(UClass* CharacterClass, TArray<FSoftObjectPath>& OutPaths, bool OnlyMissing)
+{
+	const AALCharacter* Defaults = CharacterClass->GetDefaultObject<AALCharacter>();
+	Defaults->GatherPreloadAssets(OutPaths);
+
+	OutPaths.RemoveAll([OnlyMissing](const FSoftObjectPath& Path) { return Path.IsNull() || (OnlyMissing && Path.ResolveObject() != nullptr); });
+}
+
+void UALAssetStreamingSubsystem::StartRequest(UClass* CharacterClass, FArchetype& Archetype)
+{
+	TArray<FSoftObjectPath> Paths;
+	GatherAssets(CharacterClass, Paths, true);
+	if (Paths.Num() == 0)
+	{
+		FinishArchetype(CharacterClass, Archetype);
+		return;
+	}
+
+	NumActiveRequests++;
+	Archetype.NumPasses++;
+
+	const TWeakObjectPtr<UClass> WeakCharacterClass = CharacterClass;
+	const int32 LoadPriority = FStreamableManager::DefaultAsyncLoadPriority + static_cast<int32>(Archetype.Priority) * 50;
+	const FStreamableDelegate OnCompleted = FStreamableDelegate::CreateUObject(this, &UALAssetStreamingSubsystem::HandleRequestCompleted, WeakCharacterClass);
+
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(Paths, OnCompleted, LoadPriority);
+
+	// Looked up again, the request can complete inside RequestAsyncLoad and its listeners can add archetypes
+	if (FArchetype* Requested = Archetypes.Find(WeakCharacterClass))
+		Requested->Handles.Add(Handle);
+}
+
+void UALAssetStreamingSubsystem::HandleRequestCompleted(TWeakObjectPtr<UClass> WeakCharacterClass)
+{
+	NumActiveRequests--;
+
+	UClass* CharacterClass = WeakCharacterClass.Get();
+	FArchetype* Archetype = Archetypes.Find(WeakCharacterClass);
+	if (CharacterClass == nullptr || Archetype == nullptr)
+		return;
+
+	// A path that failed to load (a missing or renamed asset) would be gathered again every pass, so the archetype is
+	// finished after the second one whatever is left
+	if (Archetype->NumPasses >= MaxPasses)
+	{
+		FinishArchetype(CharacterClass, *Archetype);
+		return;
+	}
+
+	// The ability components are only known now that the ability set itself is loaded. StartRequest finishes the
+	// archetype when there's nothing left.
+	StartRequest(CharacterClass, *Archetype);
+}
+
+void UALAssetStreamingSubsystem::FinishArchetype(UClass* CharacterClass, FArchetype& Archetype)
+{
+	if (Archetype.IsLoaded)
+		return;
+
+	Archetype.IsLoaded = true;
+	Archetype.LoadSeconds = FPlatformTime::Seconds() - Archetype.RequestTime;
+
+	// Everything is in memory, so this doesn't load anything. It holds on to the assets that were loaded before the request
+	// as well, which nothing else might be referencing.
+	TArray<FSoftObjectPath> Paths;
+	GatherAssets(CharacterClass, Paths, false);
+	Paths.RemoveAll([CharacterClass](const FSoftObjectPath& Path)
+	{
+		if (Path.ResolveObject() != nullptr)
+			return false;
+
+		UE_LOG(LogALCharacter, Warning, TEXT("%s: couldn't load %s, its abilities are built without it"), *CharacterClass->GetName(), *Path.ToString());
+		return true;
+	});
+
+	if (Paths.Num() > 0)
+		Archetype.Handles.Add(StreamableManager.RequestSyncLoad(Paths));
+
+	UE_LOG(LogALStreaming, Verbose, TEXT("%s loaded in %.2f ms"), *CharacterClass->GetName(), Archetype.LoadSeconds * 1000.0);
+
+	// Moved out first, a listener could request another archetype and grow the map
+	TArray<FSimpleDelegate, TInlineAllocator<2>> OnLoaded = MoveTemp(Archetype.OnLoaded);
+	Archetype.OnLoaded.Reset();
+
+	for (const FSimpleDelegate& Delegate : OnLoaded)
+		Delegate.ExecuteIfBound();
+}
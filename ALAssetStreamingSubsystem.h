@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Engine/StreamableManager.h"
+#include "ALAssetStreamingSubsystem.generated.h"
+
+class AALCharacter;
+
+// Later entries are streamed first
+UENUM()
+enum class EALStreamingPriority : uint8
+{
+	// Warming up archetypes that will be spawned later, like the crowd's character class
+	Background,
+	// A character of this class already exists and is waiting for its abilities
+	Spawn,
+	// A player is about to control a character of this class
+	Possession
+};
+
+// Streams in what a character class (an archetype) only soft references: its ability set, the ability components in it and its
+// projectile class. Each archetype is loaded as one bundle, in two steps since the ability components are only known once the
+// set itself is in memory. Archetypes wait in a queue ordered by priority, and only MaxActiveRequests are streamed at once.
+UCLASS()
+class UALAssetStreamingSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// OnLoaded is called straight away when the archetype is loaded already. Requesting a queued archetype again with a
+	// higher priority moves it up the queue.
+	void RequestArchetype(TSubclassOf<AALCharacter> CharacterClass, EALStreamingPriority Priority, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	// For game modes and levels that know which characters they are going to spawn
+	UFUNCTION(BlueprintCallable, Category = "Streaming")
+	void PreloadArchetype(TSubclassOf<AALCharacter> CharacterClass);
+
+	bool IsArchetypeLoaded(TSubclassOf<AALCharacter> CharacterClass) const;
+	// Seconds from the first request to the whole bundle being in memory, 0 until it is
+	double GetArchetypeLoadSeconds(TSubclassOf<AALCharacter> CharacterClass) const;
+	int32 GetNumQueuedArchetypes() const { return Queue.Num(); }
+
+	UPROPERTY(EditAnywhere, Category = "Streaming", meta = (ClampMin = "1"))
+	int32 MaxActiveRequests = 2;
+
+private:
+
+	struct FArchetype
+	{
+		EALStreamingPriority Priority = EALStreamingPriority::Background;
+		double RequestTime = 0.0;
+		double LoadSeconds = 0.0;
+		bool IsLoaded = false;
+		// Async loads started so far: the set itself, then its ability components. Never more than MaxPasses.
+		int32 NumPasses = 0;
+		// Keep the soft referenced assets in memory for as long as the subsystem is around
+		TArray<TSharedPtr<FStreamableHandle>, TInlineAllocator<2>> Handles;
+		TArray<FSimpleDelegate, TInlineAllocator<2>> OnLoaded;
+	};
+
+	static constexpr int32 MaxPasses = 2;
+
+	static void GatherAssets(UClass* CharacterClass, TArray<FSoftObjectPath>& OutPaths, bool OnlyMissing);
+
+	void StartRequest(UClass* CharacterClass, FArchetype& Archetype);
+	void HandleRequestCompleted(TWeakObjectPtr<UClass> WeakCharacterClass);
+	void FinishArchetype(UClass* CharacterClass, FArchetype& Archetype);
+
+	FStreamableManager StreamableManager;
+	TMap<TWeakObjectPtr<UClass>, FArchetype> Archetypes;
+	TArray<TWeakObjectPtr<UClass>> Queue;
+	int32 NumActiveRequests = 0;
+};
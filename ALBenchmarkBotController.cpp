@@ -0,0 +1,127 @@
+#include "ALBenchmarkBotController.h"
+#include "AALCharacter.h"
+
+AALBenchmarkBotController::AALBenchmarkBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Input has to be in before the character moves, the same as a player's
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+}
+
+void AALBenchmarkBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	AALCharacter* Character = Cast<AALCharacter>(GetPawn());
+	if (Character == nullptr)
+		return;
+
+	GoalTime += DeltaSeconds;
+	if (GoalTime >= GoalDuration)
+		ChooseGoal(Character);
+
+	switch (Goal)
+	{
+	case EBotGoal::Jump:
+		// The second press, once airborne, is the double jump
+		if (!HasDoubleJumped && GoalTime > 0.25f)
+		{
+			HasDoubleJumped = true;
+			Character->DispatchInputAction(EALInputAction::Jump);
+		}
+		break;
+	case EBotGoal::Dash:
+		// Dashing is sprint pressed while airborne
+		if (!HasDashed && GoalTime > 0.2f)
+		{
+			HasDashed = true;
+			Character->DispatchInputAction(EALInputAction::SprintPressed);
+		}
+		break;
+	case EBotGoal::GlideOnOil:
+		Heading = (GlideTarget - Character->GetActorLocation()).Rotation().Yaw;
+		break;
+	default:
+		break;
+	}
+
+	SetControlRotation(FRotator(0.f, Heading, 0.f));
+	Character->DispatchInputAxis(1.f, EALInputAxis::MoveForward);
+	Character->DispatchInputAxis(FMath::Sin(GoalTime * 2.f) * 0.5f, EALInputAxis::MoveRight);
+}
+
+void AALBenchmarkBotController::ChooseGoal(AALCharacter* Character)
+{
+	StopGoal(Character);
+
+	EBotGoal NewGoal = static_cast<EBotGoal>(Random.RandHelper(static_cast<int32>(EBotGoal::Count)));
+	if (NewGoal == EBotGoal::GlideOnOil && (OilPatches == nullptr || OilPatches->Num() == 0))
+		NewGoal = EBotGoal::Sprint;
+
+	StartGoal(Character, NewGoal);
+}
+
+void AALBenchmarkBotController::StartGoal(AALCharacter* Character, EBotGoal NewGoal)
+{
+	Goal = NewGoal;
+	GoalTime = 0.f;
+	GoalDuration = Random.FRandRange(1.f, 3.f);
+	Heading = Random.FRandRange(-180.f, 180.f);
+	HasDoubleJumped = false;
+	HasDashed = false;
+
+	switch (Goal)
+	{
+	case EBotGoal::Sprint:
+		Character->DispatchInputAction(EALInputAction::SprintPressed);
+		break;
+	case EBotGoal::Sneak:
+		Character->DispatchInputAction(EALInputAction::SneakPressed);
+		break;
+	case EBotGoal::Jump:
+	case EBotGoal::Dash:
+		Character->DispatchInputAction(EALInputAction::Jump);
+		break;
+	case EBotGoal::Fire:
+		Character->DispatchInputAction(EALInputAction::AbilitySlot0);
+		break;
+	case EBotGoal::GlideOnOil:
+	{
+		// Nearest patch, held down with sprint so the character glides once it's on it
+		const FVector Location = Character->GetActorLocation();
+		float BestDistanceSquared = MAX_FLT;
+		for (const FBox& Patch : *OilPatches)
+		{
+			const float DistanceSquared = FVector::DistSquared2D(Patch.GetCenter(), Location);
+			if (DistanceSquared < BestDistanceSquared)
+			{
+				BestDistanceSquared = DistanceSquared;
+				GlideTarget = Patch.GetCenter();
+			}
+		}
+
+		GoalDuration = Random.FRandRange(4.f, 8.f);
+		Character->DispatchInputAction(EALInputAction::SprintPressed);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void AALBenchmarkBotController::StopGoal(AALCharacter* Character)
+{
+	switch (Goal)
+	{
+	case EBotGoal::Sprint:
+	case EBotGoal::Dash:
+	case EBotGoal::GlideOnOil:
+		Character->DispatchInputAction(EALInputAction::SprintReleased);
+		break;
+	case EBotGoal::Sneak:
+		Character->DispatchInputAction(EALInputAction::SneakReleased);
+		break;
+	default:
+		break;
+	}
+}
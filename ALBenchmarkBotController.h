@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "ALBenchmarkBotController.generated.h"
+
+class AALCharacter;
+
+// Plays an AALCharacter for the bot benchmark by sending it the same actions and axes the player's input does, so every
+// measured frame runs the real input handlers. It wanders, sprints, sneaks, jumps, double jumps, dashes, fires the first
+// ability slot, and every so often heads for the nearest oil patch to glide over it.
+UCLASS()
+class AALBenchmarkBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+
+	AALBenchmarkBotController();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Patches to glide over, shared by every bot of a benchmark run
+	void SetOilPatches(const TArray<FBox>* InOilPatches) { OilPatches = InOilPatches; }
+	void SetSeed(int32 Seed) { Random.Initialize(Seed); }
+
+private:
+
+	enum class EBotGoal : uint8
+	{
+		Wander,
+		Sprint,
+		Sneak,
+		Jump,
+		Dash,
+		Fire,
+		GlideOnOil,
+
+		Count
+	};
+
+	void ChooseGoal(AALCharacter* Character);
+	void StartGoal(AALCharacter* Character, EBotGoal NewGoal);
+	void StopGoal(AALCharacter* Character);
+
+	const TArray<FBox>* OilPatches = nullptr;
+	FRandomStream Random;
+
+	EBotGoal Goal = EBotGoal::Wander;
+	float GoalTime = 0.f;
+	float GoalDuration = 0.f;
+	float Heading = 0.f;
+	FVector GlideTarget = FVector::ZeroVector;
+	bool HasDoubleJumped = false;
+	bool HasDashed = false;
+};
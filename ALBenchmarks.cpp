@@ -0,0 +1,1117 @@
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/World.h"
+#include "ALCrowdSubsystem.h"
+#include "ALProjectilePool.h"
+#include "ALPushSubsystem.h"
+#include "ALAssetStreamingSubsystem.h"
+#include "ALCharacterPool.h"
+#include "ALTelemetry.h"
+#include "Components/StaticMeshComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Misc/App.h"
+#include "AALCharacter.h"
+#include "ALBenchmarkBotController.h"
+#include "Components/ALSlipperyOil.h"
+#include "Engine/EngineBaseTypes.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogALBenchmark, Log, All);
+
+// Benchmarks are console commands so they run on any map, including headless sessions. For example:
+// UE4Editor-Cmd <Project>.uproject <Map> -game -nullrhi -unattended -ExecCmds="AL.Bench.Crowd 600,quit"
+
+namespace ALBenchmarks
+{
+	static double Percentile(const TArray<double>& SortedValues, float Percent)
+	{
+		if (SortedValues.Num() == 0)
+			return 0.0;
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(SortedValues.Num() * Percent) - 1, 0, SortedValues.Num() - 1);
+		return SortedValues[Index];
+	}
+
+	static void LogFrameTimes(const FString& Label, TArray<double>& Milliseconds)
+	{
+		Milliseconds.Sort();
+
+		double Total = 0.0;
+		for (double Value : Milliseconds)
+			Total += Value;
+
+		UE_LOG(LogALBenchmark, Display, TEXT("%s: avg %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms (%d frames)"),
+			*Label,
+			Milliseconds.Num() > 0 ? Total / Milliseconds.Num() : 0.0,
+			Percentile(Milliseconds, 0.5f),
+			Percentile(Milliseconds, 0.95f),
+			Percentile(Milliseconds, 0.99f),
+			Milliseconds.Num() > 0 ? Milliseconds.Last() : 0.0,
+			Milliseconds.Num());
+	}
+
+	static int32 FramesFromArgs(const TArray<FString>& Args, int32 Default)
+	{
+		return Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : Default;
+	}
+
+	// Game-thread time of one crowd simulation step, with the worker threads doing the actual processing
+	static void RunCrowdBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UALCrowdSubsystem* Crowd = World ? World->GetSubsystem<UALCrowdSubsystem>() : nullptr;
+		if (Crowd == nullptr)
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.Crowd needs a game world"));
+			return;
+		}
+
+		const int32 Frames = FramesFromArgs(Args, 300);
+		const int32 WarmupFrames = 10;
+		const float DeltaSeconds = 1.f / 60.f;
+		const int32 AgentCounts[] = { 100, 1000, 5000 };
+
+		// Nothing may be spawned while measuring
+		const bool WasPromotionEnabled = Crowd->PromotionEnabled;
+		Crowd->PromotionEnabled = false;
+		Crowd->RefreshOilPatches();
+
+		for (int32 AgentCount : AgentCounts)
+		{
+			Crowd->RemoveAllAgents();
+			Crowd->SpawnAgents(AgentCount, FVector::ZeroVector, 10000.f);
+
+			for (int32 i = 0; i < WarmupFrames; i++)
+				Crowd->Simulate(DeltaSeconds);
+
+			TArray<double> Milliseconds;
+			Milliseconds.Reserve(Frames);
+
+			for (int32 i = 0; i < Frames; i++)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				Crowd->Simulate(DeltaSeconds);
+				Milliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+			}
+
+			LogFrameTimes(FString::Printf(TEXT("Crowd %d agents"), AgentCount), Milliseconds);
+		}
+
+		Crowd->RemoveAllAgents();
+		Crowd->PromotionEnabled = WasPromotionEnabled;
+	}
+
+	// Fires a volley every frame and retires each projectile after a fixed number of frames, once by spawning and destroying
+	// and once through the pool. A garbage collection is forced at the engine's default interval so its cost lands in the frame it runs in.
+	static void RunProjectileBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UALProjectilePoolSubsystem* Pool = World ? World->GetSubsystem<UALProjectilePoolSubsystem>() : nullptr;
+		UClass* ProjectileClass = Args.Num() > 0 ? LoadClass<AActor>(nullptr, *Args[0]) : nullptr;
+		if (Pool == nullptr || ProjectileClass == nullptr)
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.Projectiles needs a game world and a projectile class path"));
+			return;
+		}
+
+		const int32 Frames = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 600;
+		const int32 VolleySize = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 8;
+		const int32 LifeFrames = 30;
+		const int32 GarbageCollectionFrames = 60 * 60;
+		const int32 GarbageCollectionInterval = FMath::Min(GarbageCollectionFrames, FMath::Max(Frames / 4, 1));
+
+		auto RunVolleys = [&](const FString& Label, TFunctionRef<AActor*(const FTransform&)> Fire, TFunctionRef<void(AActor*)> Retire)
+		{
+			TArray<TArray<AActor*>> InFlight;
+			InFlight.SetNum(LifeFrames);
+
+			TArray<double> Milliseconds;
+			Milliseconds.Reserve(Frames);
+
+			for (int32 Frame = 0; Frame < Frames; Frame++)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+
+				TArray<AActor*>& Slot = InFlight[Frame % LifeFrames];
+				for (AActor* Actor : Slot)
+					Retire(Actor);
+				Slot.Reset();
+
+				for (int32 i = 0; i < VolleySize; i++)
+				{
+					const FTransform Transform(FRotator(0.f, 360.f * i / VolleySize, 0.f), FVector(0.f, 0.f, 10000.f + Frame));
+					if (AActor* Actor = Fire(Transform))
+						Slot.Add(Actor);
+				}
+
+				if ((Frame + 1) % GarbageCollectionInterval == 0)
+					CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+				Milliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+			}
+
+			for (TArray<AActor*>& Slot : InFlight)
+			{
+				for (AActor* Actor : Slot)
+					Retire(Actor);
+			}
+
+			LogFrameTimes(Label, Milliseconds);
+		};
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		RunVolleys(FString::Printf(TEXT("Projectiles spawned, %d per frame"), VolleySize),
+			[&](const FTransform& Transform) { return World->SpawnActor<AActor>(ProjectileClass, Transform, SpawnParams); },
+			[](AActor* Actor) { Actor->Destroy(); });
+
+		Pool->Prewarm(ProjectileClass, VolleySize * LifeFrames);
+
+		RunVolleys(FString::Printf(TEXT("Projectiles pooled, %d per frame"), VolleySize),
+			[&](const FTransform& Transform) { return Pool->AcquireActor(ProjectileClass, Transform); },
+			[&](AActor* Actor) { Pool->ReleaseActor(Actor); });
+
+		const FALActorPoolStats Stats = Pool->GetStats(ProjectileClass);
+		UE_LOG(LogALBenchmark, Display, TEXT("Projectile pool: peak %d in use of %d capacity, %d misses"), Stats.PeakInUse, Stats.Capacity, Stats.Misses);
+	}
+
+	static TArray<AActor*> SpawnPhysicsBodies(UWorld* World, const FVector& Center, int32 Count)
+	{
+		TArray<AActor*> Bodies;
+
+		UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		if (CubeMesh == nullptr)
+			return Bodies;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+		const float Spacing = 120.f;
+		const FVector Corner = Center - FVector(Side * Spacing * 0.5f, Side * Spacing * 0.5f, 0.f);
+
+		Bodies.Reserve(Count);
+		for (int32 i = 0; i < Count; i++)
+		{
+			const FVector Location = Corner + FVector((i % Side) * Spacing, (i / Side) * Spacing, 0.f);
+			AStaticMeshActor* Body = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator, SpawnParams);
+			if (Body == nullptr)
+				continue;
+
+			UStaticMeshComponent* MeshComponent = Body->GetStaticMeshComponent();
+			MeshComponent->SetMobility(EComponentMobility::Movable);
+			MeshComponent->SetStaticMesh(CubeMesh);
+			MeshComponent->SetCollisionProfileName(UCollisionProfile::PhysicsActor_ProfileName);
+			MeshComponent->SetSimulatePhysics(true);
+			Bodies.Add(Body);
+		}
+
+		return Bodies;
+	}
+
+	static FString FrameTimesToJson(TArray<double>& Milliseconds)
+	{
+		Milliseconds.Sort();
+
+		double Total = 0.0;
+		for (double Value : Milliseconds)
+			Total += Value;
+
+		return FString::Printf(TEXT("{ \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }"),
+			Milliseconds.Num() > 0 ? Total / Milliseconds.Num() : 0.0,
+			Percentile(Milliseconds, 0.5f),
+			Percentile(Milliseconds, 0.95f),
+			Percentile(Milliseconds, 0.99f),
+			Milliseconds.Num() > 0 ? Milliseconds.Last() : 0.0);
+	}
+
+	// Records the time a tick group is reached, so the physics part of the frame can be timed
+	struct FTickGroupMarker : public FTickFunction
+	{
+		double Time = 0.0;
+
+		FTickGroupMarker()
+		{
+			bCanEverTick = true;
+			bTickEvenWhenPaused = true;
+		}
+
+		virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override
+		{
+			Time = FPlatformTime::Seconds();
+		}
+
+		virtual FString DiagnosticMessage() override { return TEXT("ALBenchmarks::FTickGroupMarker"); }
+	};
+
+	// Spawns bot-driven characters in growing numbers and measures each step. Runs on its own from world tick delegates.
+	class FBotBenchmark : public TSharedFromThis<FBotBenchmark>
+	{
+	public:
+
+		FBotBenchmark(UWorld* InWorld, int32 InMaxBots, float InSecondsPerStep)
+			: World(InWorld)
+			, MaxBots(InMaxBots)
+			, SecondsPerStep(InSecondsPerStep)
+		{
+			// Budgets for the 95th percentile game-thread time and the memory each bot may cost. Override them to match the target hardware.
+			FParse::Value(FCommandLine::Get(), TEXT("ALBenchBudgetMs="), BaseBudgetMs);
+			FParse::Value(FCommandLine::Get(), TEXT("ALBenchBudgetMsPerBot="), BudgetMsPerBot);
+			FParse::Value(FCommandLine::Get(), TEXT("ALBenchMemoryMBPerBot="), MemoryMBPerBot);
+			ExitWhenFinished = FParse::Param(FCommandLine::Get(), TEXT("ALBenchExit"));
+		}
+
+		void Start()
+		{
+			for (TActorIterator<AActor> It(World.Get()); It; ++It)
+			{
+				if (It->FindComponentByClass<UALSlipperyOil>())
+					OilPatches.Add(It->GetComponentsBoundingBox());
+			}
+
+			SpawnCenter = FVector(0.f, 0.f, 200.f);
+			for (TActorIterator<APlayerStart> It(World.Get()); It; ++It)
+			{
+				SpawnCenter = It->GetActorLocation();
+				break;
+			}
+
+			// The designers' character if the game mode uses one, so the bots run with the real tuning and components
+			CharacterClass = AALCharacter::StaticClass();
+			if (const AGameModeBase* GameMode = World->GetAuthGameMode())
+			{
+				if (GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf(AALCharacter::StaticClass()))
+					CharacterClass = GameMode->DefaultPawnClass;
+			}
+
+			StartPhysicsMarker.TickGroup = TG_StartPhysics;
+			StartPhysicsMarker.EndTickGroup = TG_StartPhysics;
+			StartPhysicsMarker.RegisterTickFunction(World->PersistentLevel);
+			EndPhysicsMarker.TickGroup = TG_EndPhysics;
+			EndPhysicsMarker.EndTickGroup = TG_EndPhysics;
+			EndPhysicsMarker.RegisterTickFunction(World->PersistentLevel);
+
+			BaselineMemory = FPlatformMemory::GetStats().UsedPhysical;
+
+			TickStartHandle = FWorldDelegates::OnWorldTickStart.AddSP(this, &FBotBenchmark::HandleWorldTickStart);
+			PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddSP(this, &FBotBenchmark::HandleWorldPostActorTick);
+
+			StartStep(FMath::Min(8, MaxBots));
+		}
+
+	private:
+
+		struct FStepResult
+		{
+			int32 NumBots;
+			TArray<double> GameThreadMilliseconds;
+			TArray<double> WorldTickMilliseconds;
+			TArray<double> PhysicsMilliseconds;
+			double MemoryMB = 0.0;
+			double BudgetMs = 0.0;
+			bool Passed = true;
+		};
+
+		void StartStep(int32 NumBots)
+		{
+			while (Bots.Num() < NumBots)
+			{
+				const int32 Index = Bots.Num();
+				const FVector Offset = FRotator(0.f, Index * 137.5f, 0.f).Vector() * (300.f + 40.f * Index);
+				const FTransform Transform(FRotator::ZeroRotator, SpawnCenter + Offset);
+
+				AALCharacter* Character = World->SpawnActorDeferred<AALCharacter>(CharacterClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+				if (Character == nullptr)
+					break;
+
+				Character->AutoPossessPlayer = EAutoReceiveInput::Disabled;
+				Character->AutoPossessAI = EAutoPossessAI::Spawned;
+				Character->AIControllerClass = AALBenchmarkBotController::StaticClass();
+				Character->FinishSpawning(Transform);
+
+				if (AALBenchmarkBotController* Bot = Cast<AALBenchmarkBotController>(Character->GetController()))
+				{
+					Bot->SetOilPatches(&OilPatches);
+					Bot->SetSeed(Index);
+				}
+
+				Bots.Add(Character);
+			}
+
+			FStepResult& Step = Results.AddDefaulted_GetRef();
+			Step.NumBots = Bots.Num();
+			Step.BudgetMs = BaseBudgetMs + BudgetMsPerBot * Step.NumBots;
+
+			// Two seconds for the bots to land and spread out before anything is measured
+			const double Now = FPlatformTime::Seconds();
+			MeasureStartTime = Now + 2.0;
+			StepEndTime = MeasureStartTime + SecondsPerStep;
+		}
+
+		void HandleWorldTickStart(UWorld* TickWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickWorld == World.Get())
+				WorldTickStartTime = FPlatformTime::Seconds();
+		}
+
+		void HandleWorldPostActorTick(UWorld* TickWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickWorld != World.Get())
+				return;
+
+			const double Now = FPlatformTime::Seconds();
+			if (Now < MeasureStartTime)
+				return;
+
+			FStepResult& Step = Results.Last();
+			Step.GameThreadMilliseconds.Add(FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0);
+			Step.WorldTickMilliseconds.Add((Now - WorldTickStartTime) * 1000.0);
+			Step.PhysicsMilliseconds.Add(FMath::Max(EndPhysicsMarker.Time - StartPhysicsMarker.Time, 0.0) * 1000.0);
+
+			if (Now < StepEndTime)
+				return;
+
+			Step.MemoryMB = static_cast<double>(FPlatformMemory::GetStats().UsedPhysical - BaselineMemory) / (1024.0 * 1024.0);
+
+			if (Bots.Num() > 0 && Bots.Num() * 4 <= MaxBots)
+				StartStep(Bots.Num() * 4);
+			else
+				Finish();
+		}
+
+		void Finish()
+		{
+			FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+			FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+			StartPhysicsMarker.UnRegisterTickFunction();
+			EndPhysicsMarker.UnRegisterTickFunction();
+
+			bool AllPassed = true;
+			TArray<FString> StepJson;
+
+			for (FStepResult& Step : Results)
+			{
+				LogFrameTimes(FString::Printf(TEXT("Bots %d, game thread"), Step.NumBots), Step.GameThreadMilliseconds);
+				LogFrameTimes(FString::Printf(TEXT("Bots %d, physics"), Step.NumBots), Step.PhysicsMilliseconds);
+
+				const double GameThreadP95 = Percentile(Step.GameThreadMilliseconds, 0.95f);
+				const double StepMemoryMBPerBot = Step.MemoryMB / FMath::Max(Step.NumBots, 1);
+				Step.Passed = GameThreadP95 <= Step.BudgetMs && StepMemoryMBPerBot <= MemoryMBPerBot;
+				AllPassed &= Step.Passed;
+
+				if (!Step.Passed)
+				{
+					UE_LOG(LogALBenchmark, Error, TEXT("Bots %d over budget: p95 %.3f ms of %.3f ms, %.2f MB per bot of %.2f MB"),
+						Step.NumBots, GameThreadP95, Step.BudgetMs, StepMemoryMBPerBot, MemoryMBPerBot);
+				}
+
+				StepJson.Add(FString::Printf(TEXT("\t\t{ \"bots\": %d, \"frames\": %d, \"game_thread_ms\": %s, \"world_tick_ms\": %s, \"physics_ms\": %s, \"memory_mb\": %.2f, \"memory_mb_per_bot\": %.3f, \"budget_ms\": %.3f, \"passed\": %s }"),
+					Step.NumBots,
+					Step.GameThreadMilliseconds.Num(),
+					*FrameTimesToJson(Step.GameThreadMilliseconds),
+					*FrameTimesToJson(Step.WorldTickMilliseconds),
+					*FrameTimesToJson(Step.PhysicsMilliseconds),
+					Step.MemoryMB,
+					StepMemoryMBPerBot,
+					Step.BudgetMs,
+					Step.Passed ? TEXT("true") : TEXT("false")));
+			}
+
+			const FString Json = FString::Printf(TEXT("{\n\t\"benchmark\": \"bots\",\n\t\"character\": \"%s\",\n\t\"passed\": %s,\n\t\"steps\": [\n%s\n\t]\n}\n"),
+				*GetNameSafe(CharacterClass), AllPassed ? TEXT("true") : TEXT("false"), *FString::Join(StepJson, TEXT(",\n")));
+
+			const FString Filename = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("BotBenchmark.json");
+			FFileHelper::SaveStringToFile(Json, *Filename);
+			UE_LOG(LogALBenchmark, Display, TEXT("Bot benchmark %s, results in %s"), AllPassed ? TEXT("passed") : TEXT("failed"), *Filename);
+
+			for (const TWeakObjectPtr<AALCharacter>& Bot : Bots)
+			{
+				if (!Bot.IsValid())
+					continue;
+
+				if (AController* Controller = Bot->GetController())
+					Controller->Destroy();
+				Bot->Destroy();
+			}
+			Bots.Reset();
+
+			// A failed run exits with an error code so the build that ran it fails
+			if (ExitWhenFinished)
+				FPlatformMisc::RequestExitWithStatus(false, AllPassed ? 0 : 1);
+		}
+
+		TWeakObjectPtr<UWorld> World;
+		int32 MaxBots;
+		float SecondsPerStep;
+		float BaseBudgetMs = 8.f;
+		float BudgetMsPerBot = 0.05f;
+		float MemoryMBPerBot = 2.f;
+		bool ExitWhenFinished = false;
+
+		UClass* CharacterClass = nullptr;
+		FVector SpawnCenter;
+		TArray<FBox> OilPatches;
+		TArray<TWeakObjectPtr<AALCharacter>> Bots;
+		TArray<FStepResult> Results;
+
+		FTickGroupMarker StartPhysicsMarker;
+		FTickGroupMarker EndPhysicsMarker;
+		uint64 BaselineMemory = 0;
+		double WorldTickStartTime = 0.0;
+		double MeasureStartTime = 0.0;
+		double StepEndTime = 0.0;
+
+		FDelegateHandle TickStartHandle;
+		FDelegateHandle PostActorTickHandle;
+	};
+
+	// Kept alive until its run is over
+	static TSharedPtr<FBotBenchmark> ActiveBotBenchmark;
+
+	static void RunBotBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || !World->IsGameWorld())
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.Bots needs a game world"));
+			return;
+		}
+
+		const int32 MaxBots = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 128;
+		const float SecondsPerStep = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 1.f) : 20.f;
+
+		ActiveBotBenchmark = MakeShared<FBotBenchmark>(World, MaxBots, SecondsPerStep);
+		ActiveBotBenchmark->Start();
+	}
+
+	// Samples the server for a number of seconds, then logs its tick time and the bandwidth each connected player costs.
+	// Run it on a dedicated or listen server with N clients connected, and repeat for a growing N. Clients can replay a
+	// recorded input file so every player actually moves, for example:
+	// UE4Editor-Cmd <Project>.uproject <Map> -server -log -ExecCmds="AL.Bench.ServerLoad 60"
+	// UE4Editor-Cmd <Project>.uproject 127.0.0.1 -game -nullrhi -unattended -ALReplayInput=<File> (once per client)
+	// With NetProfile as the second argument the run is also captured to a .nprof file for the Network Profiler. Running it
+	// once with "net.IsPushModelEnabled 0" and once with 1 compares the cost of the characters' cosmetic movement state.
+	static void RunServerLoadBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		if (NetDriver == nullptr || !NetDriver->IsServer())
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.ServerLoad has to run on a server"));
+			return;
+		}
+
+		struct FServerLoadSamples
+		{
+			TArray<double> TickMilliseconds;
+			double OutBytesPerPlayer = 0.0;
+			double InBytesPerPlayer = 0.0;
+			int32 BandwidthSamples = 0;
+			int32 MaxPlayers = 0;
+			int32 MaxCharacters = 0;
+			double NextBandwidthSample = 0.0;
+		};
+
+		const double Seconds = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 1.f) : 30.0;
+		const double EndTime = FPlatformTime::Seconds() + Seconds;
+		TSharedRef<FServerLoadSamples> Samples = MakeShared<FServerLoadSamples>();
+		TWeakObjectPtr<UNetDriver> WeakNetDriver = NetDriver;
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+
+		const bool NetProfile = Args.Num() > 1 && Args[1].Equals(TEXT("NetProfile"), ESearchCase::IgnoreCase);
+		if (NetProfile)
+			GEngine->Exec(World, TEXT("netprofile enable"));
+
+		const IConsoleVariable* PushModelCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("net.IsPushModelEnabled"));
+		const bool PushModel = PushModelCVar && PushModelCVar->GetBool();
+
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([=](float)
+		{
+			UNetDriver* Driver = WeakNetDriver.Get();
+			if (Driver == nullptr)
+				return false;
+
+			// Time the server spent working, without the sleep that caps its tick rate
+			Samples->TickMilliseconds.Add(FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0);
+
+			// Connections update their byte rates about once a second
+			const double Now = FPlatformTime::Seconds();
+			const int32 NumPlayers = Driver->ClientConnections.Num();
+			if (Now >= Samples->NextBandwidthSample && NumPlayers > 0)
+			{
+				Samples->NextBandwidthSample = Now + 1.0;
+
+				int64 OutBytes = 0;
+				int64 InBytes = 0;
+				for (const UNetConnection* Connection : Driver->ClientConnections)
+				{
+					OutBytes += Connection->OutBytesPerSecond;
+					InBytes += Connection->InBytesPerSecond;
+				}
+
+				Samples->OutBytesPerPlayer += static_cast<double>(OutBytes) / NumPlayers;
+				Samples->InBytesPerPlayer += static_cast<double>(InBytes) / NumPlayers;
+				Samples->BandwidthSamples++;
+			}
+			Samples->MaxPlayers = FMath::Max(Samples->MaxPlayers, NumPlayers);
+
+			if (UWorld* SampledWorld = WeakWorld.Get())
+			{
+				int32 NumCharacters = 0;
+				for (TActorIterator<AALCharacter> It(SampledWorld); It; ++It)
+					NumCharacters++;
+				Samples->MaxCharacters = FMath::Max(Samples->MaxCharacters, NumCharacters);
+			}
+
+			if (Now < EndTime)
+				return true;
+
+			if (NetProfile)
+				GEngine->Exec(WeakWorld.Get(), TEXT("netprofile disable"));
+
+			LogFrameTimes(FString::Printf(TEXT("Server tick, %d players"), Samples->MaxPlayers), Samples->TickMilliseconds);
+
+			const int32 BandwidthSamples = FMath::Max(Samples->BandwidthSamples, 1);
+			UE_LOG(LogALBenchmark, Display, TEXT("Server bandwidth, %d players: %.2f KB/s out and %.2f KB/s in per player"),
+				Samples->MaxPlayers, Samples->OutBytesPerPlayer / BandwidthSamples / 1024.0, Samples->InBytesPerPlayer / BandwidthSamples / 1024.0);
+
+			// Every player receives every other character, so this is roughly what one replicated character costs each connection
+			const int32 OtherCharacters = FMath::Max(Samples->MaxCharacters - 1, 1);
+			UE_LOG(LogALBenchmark, Display, TEXT("Server bandwidth, %d characters, push model %s: %.1f bytes/s out per replicated character and connection"),
+				Samples->MaxCharacters, PushModel ? TEXT("on") : TEXT("off"), Samples->OutBytesPerPlayer / BandwidthSamples / OtherCharacters);
+			return false;
+		}));
+	}
+
+	// Pushes a grid of simulated cubes, first the way the push used to work (a blocking overlap and an impulse per body in the
+	// same frame) and then through the push subsystem, whose cost is sampled every frame until its queue is drained.
+	static void RunPushBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UALPushSubsystem* PushSubsystem = World ? World->GetSubsystem<UALPushSubsystem>() : nullptr;
+		if (PushSubsystem == nullptr)
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.Push needs a game world"));
+			return;
+		}
+
+		const int32 BodyCount = FMath::Clamp(FramesFromArgs(Args, 1000), 500, 2000);
+		const FVector Center(0.f, 0.f, 5000.f);
+		const float Radius = FMath::Sqrt(static_cast<float>(BodyCount)) * 120.f;
+		const float Strength = 10000.f;
+
+		TArray<AActor*> Bodies = SpawnPhysicsBodies(World, Center, BodyCount);
+		if (Bodies.Num() == 0)
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.Push couldn't spawn any bodies"));
+			return;
+		}
+
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			TArray<FOverlapResult> Overlaps;
+			World->OverlapMultiByChannel(Overlaps, Center, FQuat::Identity, PushSubsystem->PushChannel, FCollisionShape::MakeSphere(Radius));
+			for (const FOverlapResult& Overlap : Overlaps)
+			{
+				UPrimitiveComponent* Component = Overlap.GetComponent();
+				if (Component && Component->IsSimulatingPhysics())
+					Component->AddImpulse((Component->GetComponentLocation() - Center).GetSafeNormal() * Strength);
+			}
+
+			UE_LOG(LogALBenchmark, Display, TEXT("Push blocking, %d bodies: %.3f ms in one frame"), Bodies.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		PushSubsystem->QueuePush(nullptr, Center, Radius, Strength);
+		const double QueueMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		TWeakObjectPtr<UALPushSubsystem> WeakPushSubsystem = PushSubsystem;
+		TArray<TWeakObjectPtr<AActor>> WeakBodies(Bodies);
+		TSharedRef<TArray<double>> Milliseconds = MakeShared<TArray<double>>();
+		Milliseconds->Add(QueueMilliseconds);
+		const int32 NumBodies = Bodies.Num();
+
+		uint64 LastSampledFrame = GFrameCounter;
+
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([=](float) mutable
+		{
+			UALPushSubsystem* Push = WeakPushSubsystem.Get();
+			if (Push == nullptr)
+				return false;
+
+			if (Push->GetLastProcessedFrame() > LastSampledFrame)
+			{
+				LastSampledFrame = Push->GetLastProcessedFrame();
+				Milliseconds->Add(Push->GetLastFrameMilliseconds());
+			}
+
+			if (Push->GetNumPendingPushes() > 0 || Push->GetNumPendingImpulses() > 0)
+				return true;
+
+			LogFrameTimes(FString::Printf(TEXT("Push async, %d bodies"), NumBodies), *Milliseconds);
+
+			for (const TWeakObjectPtr<AActor>& Body : WeakBodies)
+			{
+				if (Body.IsValid())
+					Body->Destroy();
+			}
+			return false;
+		}));
+	}
+
+	// Spawns Count characters as full instances, samples the game thread for a number of frames, and then does the same with
+	// proxies. Logs the spawn time, memory, registered components and component ticks each variant costs per character.
+	// A proxy spawn registers the camera stack and then unregisters it, so its spawn time includes both; the saving is in
+	// the frames after it, not in registration avoided.
+	static void RunProxyBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || !World->IsGameWorld())
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.Proxy needs a game world"));
+			return;
+		}
+
+		struct FProxyRun
+		{
+			bool IsProxy = false;
+			int32 FramesLeft = 0;
+			uint64 BaselineMemory = 0;
+			double MemoryBytes = 0.0;
+			double SpawnMilliseconds = 0.0;
+			int32 RegisteredComponents = 0;
+			int32 TickingComponents = 0;
+			TArray<double> Milliseconds;
+			TArray<TWeakObjectPtr<AALCharacter>> Characters;
+		};
+
+		const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 256;
+		const int32 Frames = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 300;
+		UClass* CharacterClass = Args.Num() > 2 ? LoadClass<AALCharacter>(nullptr, *Args[2]) : AALCharacter::StaticClass();
+		if (CharacterClass == nullptr)
+			CharacterClass = AALCharacter::StaticClass();
+
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+		TWeakObjectPtr<UClass> WeakCharacterClass = CharacterClass;
+		TSharedRef<FProxyRun> Run = MakeShared<FProxyRun>();
+
+		auto SpawnCharacters = [Count](UWorld* SpawnWorld, UClass* SpawnClass, FProxyRun& ProxyRun)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			ProxyRun.BaselineMemory = FPlatformMemory::GetStats().UsedPhysical;
+
+			for (int32 i = 0; i < Count; i++)
+			{
+				const FTransform Transform(FVector((i % 16) * 300.f, (i / 16) * 300.f, 5000.f));
+				const double SpawnStart = FPlatformTime::Seconds();
+				AALCharacter* Character = SpawnWorld->SpawnActorDeferred<AALCharacter>(SpawnClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+				if (Character == nullptr)
+					break;
+
+				Character->AutoPossessPlayer = EAutoReceiveInput::Disabled;
+				Character->AutoPossessAI = EAutoPossessAI::Disabled;
+				Character->SetProxyMode(ProxyRun.IsProxy);
+				Character->FinishSpawning(Transform);
+				ProxyRun.SpawnMilliseconds += (FPlatformTime::Seconds() - SpawnStart) * 1000.0;
+				ProxyRun.Characters.Add(Character);
+
+				for (UActorComponent* Component : Character->GetComponents())
+				{
+					if (Component->IsRegistered())
+						ProxyRun.RegisteredComponents++;
+					if (Component->IsRegistered() && Component->IsComponentTickEnabled())
+						ProxyRun.TickingComponents++;
+				}
+			}
+
+			ProxyRun.MemoryBytes = static_cast<double>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<double>(ProxyRun.BaselineMemory);
+			ProxyRun.FramesLeft = Frames;
+		};
+
+		auto LogRun = [](const FProxyRun& ProxyRun)
+		{
+			const int32 NumCharacters = FMath::Max(ProxyRun.Characters.Num(), 1);
+			const TCHAR* Label = ProxyRun.IsProxy ? TEXT("proxy") : TEXT("full");
+
+			TArray<double> Milliseconds = ProxyRun.Milliseconds;
+			LogFrameTimes(FString::Printf(TEXT("Characters %s, %d spawned, game thread"), Label, ProxyRun.Characters.Num()), Milliseconds);
+
+			double Total = 0.0;
+			for (double Value : ProxyRun.Milliseconds)
+				Total += Value;
+
+			UE_LOG(LogALBenchmark, Display, TEXT("Characters %s: %.4f ms spawn (with register and unregister for proxies), %.1f KB, %.1f registered components, %.1f ticking components and %.4f ms game thread per character"),
+				Label, ProxyRun.SpawnMilliseconds / NumCharacters, ProxyRun.MemoryBytes / NumCharacters / 1024.0, static_cast<double>(ProxyRun.RegisteredComponents) / NumCharacters,
+				static_cast<double>(ProxyRun.TickingComponents) / NumCharacters, ProxyRun.Milliseconds.Num() > 0 ? Total / ProxyRun.Milliseconds.Num() / NumCharacters : 0.0);
+		};
+
+		SpawnCharacters(World, CharacterClass, *Run);
+
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([=](float)
+		{
+			UWorld* SampledWorld = WeakWorld.Get();
+			UClass* SampledClass = WeakCharacterClass.Get();
+			if (SampledWorld == nullptr || SampledClass == nullptr)
+				return false;
+
+			// Time the game thread spent working, without the sleep that caps the frame rate
+			Run->Milliseconds.Add(FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0);
+			if (--Run->FramesLeft > 0)
+				return true;
+
+			LogRun(*Run);
+
+			for (const TWeakObjectPtr<AALCharacter>& Character : Run->Characters)
+			{
+				if (Character.IsValid())
+					Character->Destroy();
+			}
+
+			if (Run->IsProxy)
+				return false;
+
+			*Run = FProxyRun();
+			Run->IsProxy = true;
+			SpawnCharacters(SampledWorld, SampledClass, *Run);
+			return true;
+		}));
+	}
+
+	// Records EventsPerFrame telemetry events every frame, spread over 512 made up characters, and logs the game-thread cost of
+	// each. The writer thread compresses and writes them to Saved/Telemetry/Benchmark.altm meanwhile.
+	static void RunTelemetryBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UALTelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UALTelemetrySubsystem>() : nullptr;
+		if (Telemetry == nullptr)
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.Telemetry needs a game world"));
+			return;
+		}
+
+		const int32 EventsPerFrame = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2048;
+		const int32 Frames = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 300;
+
+		const bool WasRecording = Telemetry->IsRecording();
+		if (!WasRecording)
+			Telemetry->StartRecording(FPaths::ProjectSavedDir() / TEXT("Telemetry") / TEXT("Benchmark.altm"));
+
+		TWeakObjectPtr<UALTelemetrySubsystem> WeakTelemetry = Telemetry;
+		TSharedRef<TArray<double>> Nanoseconds = MakeShared<TArray<double>>();
+		const uint32 DroppedBefore = Telemetry->GetNumDropped();
+
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([=](float)
+		{
+			UALTelemetrySubsystem* Recorder = WeakTelemetry.Get();
+			if (Recorder == nullptr)
+				return false;
+
+			const int32 NumEvents = static_cast<int32>(EALTelemetryEvent::Count);
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 i = 0; i < EventsPerFrame; i++)
+				Recorder->Record(static_cast<EALTelemetryEvent>(i % NumEvents), i & 511, FVector(i, i, 0.f));
+			Nanoseconds->Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000000.0 / EventsPerFrame);
+
+			if (Nanoseconds->Num() < Frames)
+				return true;
+
+			Nanoseconds->Sort();
+			double Total = 0.0;
+			for (double Value : *Nanoseconds)
+				Total += Value;
+
+			UE_LOG(LogALBenchmark, Display, TEXT("Telemetry, %d events per frame: avg %.2f ns, p99 %.2f ns per event, %u dropped"),
+				EventsPerFrame, Total / Nanoseconds->Num(), Percentile(*Nanoseconds, 0.99f), Recorder->GetNumDropped() - DroppedBefore);
+
+			if (!WasRecording)
+				Recorder->StopRecording();
+			return false;
+		}));
+	}
+
+	static void SpawnArchetypeCharacters(UWorld* World, UClass* CharacterClass, int32 Count)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		TArray<double> Milliseconds;
+		TArray<AALCharacter*> Characters;
+		for (int32 i = 0; i < Count; i++)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Characters.Add(World->SpawnActor<AALCharacter>(CharacterClass, FVector(i * 200.f, 0.f, 5000.f), FRotator::ZeroRotator, SpawnParams));
+			Milliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+		}
+
+		LogFrameTimes(FString::Printf(TEXT("Archetype spawn, %s"), *CharacterClass->GetName()), Milliseconds);
+
+		for (AALCharacter* Character : Characters)
+		{
+			if (Character)
+				Character->Destroy();
+		}
+	}
+
+	// Measures the blocking load a character archetype costs. Assets only load once per process, so every mode needs a fresh run:
+	// UE4Editor-Cmd <Project>.uproject <Map> -game -nullrhi -unattended -ExecCmds="AL.Bench.ArchetypeLoad <ClassPath> Sync"
+	// Sync loads everything the archetype soft references on the game thread, which is what its hard references used to cost
+	// on every spawn and level load. Async streams it through the streaming subsystem and logs the frame times meanwhile.
+	// Both then spawn Count characters, which should no longer load anything.
+	static void RunArchetypeLoadBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UALAssetStreamingSubsystem* Streaming = World ? World->GetSubsystem<UALAssetStreamingSubsystem>() : nullptr;
+		if (Streaming == nullptr || Args.Num() == 0)
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.ArchetypeLoad needs a game world and a character class"));
+			return;
+		}
+
+		const bool Sync = Args.Num() > 1 && Args[1].Equals(TEXT("Sync"), ESearchCase::IgnoreCase);
+		const int32 Count = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 8;
+
+		double StartTime = FPlatformTime::Seconds();
+		UClass* CharacterClass = LoadClass<AALCharacter>(nullptr, *Args[0]);
+		if (CharacterClass == nullptr)
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.ArchetypeLoad couldn't load %s"), *Args[0]);
+			return;
+		}
+		UE_LOG(LogALBenchmark, Display, TEXT("Archetype class load, %s: %.3f ms blocking"), *CharacterClass->GetName(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+		if (Sync)
+		{
+			StartTime = FPlatformTime::Seconds();
+
+			// Twice, the second pass picks up the ability components of the set loaded by the first
+			TArray<FSoftObjectPath> Paths;
+			for (int32 Pass = 0; Pass < 2; Pass++)
+			{
+				Paths.Reset();
+				CharacterClass->GetDefaultObject<AALCharacter>()->GatherPreloadAssets(Paths);
+				for (const FSoftObjectPath& Path : Paths)
+					Path.TryLoad();
+			}
+
+			UE_LOG(LogALBenchmark, Display, TEXT("Archetype assets sync, %s: %.3f ms blocking"), *CharacterClass->GetName(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			SpawnArchetypeCharacters(World, CharacterClass, Count);
+			return;
+		}
+
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+		TWeakObjectPtr<UClass> WeakCharacterClass = CharacterClass;
+		TSharedRef<TArray<double>> Milliseconds = MakeShared<TArray<double>>();
+		TSharedRef<bool> IsLoaded = MakeShared<bool>(false);
+
+		Streaming->RequestArchetype(CharacterClass, EALStreamingPriority::Possession, FSimpleDelegate::CreateLambda([IsLoaded]() { *IsLoaded = true; }));
+
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([=](float)
+		{
+			UWorld* SampledWorld = WeakWorld.Get();
+			UClass* LoadedClass = WeakCharacterClass.Get();
+			if (SampledWorld == nullptr || LoadedClass == nullptr)
+				return false;
+
+			Milliseconds->Add(FApp::GetDeltaTime() * 1000.0);
+			if (!*IsLoaded)
+				return true;
+
+			LogFrameTimes(FString::Printf(TEXT("Archetype assets async, %s, frames while streaming"), *LoadedClass->GetName()), *Milliseconds);
+
+			if (UALAssetStreamingSubsystem* LoadedStreaming = SampledWorld->GetSubsystem<UALAssetStreamingSubsystem>())
+				UE_LOG(LogALBenchmark, Display, TEXT("Archetype assets async, %s: loaded in %.3f ms"), *LoadedClass->GetName(), LoadedStreaming->GetArchetypeLoadSeconds(LoadedClass) * 1000.0);
+
+			SpawnArchetypeCharacters(SampledWorld, LoadedClass, Count);
+			return false;
+		}));
+	}
+
+	// Starts Rounds rounds of Players characters, first spawning them and destroying the last round's like a game mode does, then
+	// through the character pool. Logs the blocking ms of each round start, the game-thread frame times after it, and the garbage
+	// collection that cleans up after each round, which is where the destroyed characters cost the most.
+	static void RunRoundStartBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		UALCharacterPoolSubsystem* CharacterPool = World ? World->GetSubsystem<UALCharacterPoolSubsystem>() : nullptr;
+		if (CharacterPool == nullptr || !World->IsGameWorld())
+		{
+			UE_LOG(LogALBenchmark, Error, TEXT("AL.Bench.RoundStart needs a game world"));
+			return;
+		}
+
+		struct FRoundStartRun
+		{
+			bool IsPooled = false;
+			int32 Round = 0;
+			int32 FramesLeft = 0;
+			TArray<double> RoundStartMilliseconds;
+			TArray<double> GarbageMilliseconds;
+			TArray<double> FrameMilliseconds;
+			TArray<TWeakObjectPtr<AALCharacter>> Characters;
+		};
+
+		const int32 Players = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 32;
+		const int32 Rounds = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 5;
+		UClass* CharacterClass = Args.Num() > 2 ? LoadClass<AALCharacter>(nullptr, *Args[2]) : AALCharacter::StaticClass();
+		if (CharacterClass == nullptr)
+			CharacterClass = AALCharacter::StaticClass();
+
+		const int32 FramesPerRound = 60;
+		TWeakObjectPtr<UWorld> WeakWorld = World;
+		TWeakObjectPtr<UClass> WeakCharacterClass = CharacterClass;
+		TSharedRef<FRoundStartRun> Run = MakeShared<FRoundStartRun>();
+
+		auto EndRound = [](UALCharacterPoolSubsystem* Pool, FRoundStartRun& RoundRun)
+		{
+			for (const TWeakObjectPtr<AALCharacter>& Character : RoundRun.Characters)
+			{
+				if (!Character.IsValid())
+					continue;
+
+				if (RoundRun.IsPooled)
+					Pool->ReleaseCharacter(Character.Get());
+				else
+					Character->Destroy();
+			}
+
+			RoundRun.Characters.Reset();
+		};
+
+		auto StartRound = [Players, FramesPerRound, EndRound](UWorld* RoundWorld, UClass* RoundClass, FRoundStartRun& RoundRun)
+		{
+			UALCharacterPoolSubsystem* Pool = RoundWorld->GetSubsystem<UALCharacterPoolSubsystem>();
+			const double StartTime = FPlatformTime::Seconds();
+
+			EndRound(Pool, RoundRun);
+
+			for (int32 i = 0; i < Players; i++)
+			{
+				const FTransform Transform(FVector((i % 8) * 300.f, (i / 8) * 300.f, 300.f));
+
+				AALCharacter* Character = nullptr;
+				if (RoundRun.IsPooled)
+				{
+					Character = Pool->AcquireCharacter(RoundClass, Transform);
+				}
+				else
+				{
+					Character = RoundWorld->SpawnActorDeferred<AALCharacter>(RoundClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+					if (Character)
+					{
+						Character->AutoPossessPlayer = EAutoReceiveInput::Disabled;
+						Character->AutoPossessAI = EAutoPossessAI::Disabled;
+						Character->SetProxyMode(true);
+						Character->FinishSpawning(Transform);
+					}
+				}
+
+				if (Character)
+					RoundRun.Characters.Add(Character);
+			}
+
+			RoundRun.RoundStartMilliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+			RoundRun.FramesLeft = FramesPerRound;
+		};
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		StartRound(World, CharacterClass, *Run);
+
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([=](float)
+		{
+			UWorld* SampledWorld = WeakWorld.Get();
+			UClass* SampledClass = WeakCharacterClass.Get();
+			UALCharacterPoolSubsystem* Pool = SampledWorld ? SampledWorld->GetSubsystem<UALCharacterPoolSubsystem>() : nullptr;
+			if (Pool == nullptr || SampledClass == nullptr)
+				return false;
+
+			// Time the game thread spent working, without the sleep that caps the frame rate
+			Run->FrameMilliseconds.Add(FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0);
+			if (--Run->FramesLeft > 0)
+				return true;
+
+			const double StartTime = FPlatformTime::Seconds();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			Run->GarbageMilliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+			if (++Run->Round < Rounds)
+			{
+				StartRound(SampledWorld, SampledClass, *Run);
+				return true;
+			}
+
+			const TCHAR* Label = Run->IsPooled ? TEXT("pooled") : TEXT("spawned");
+			LogFrameTimes(FString::Printf(TEXT("Round start %s, %d players, blocking"), Label, Players), Run->RoundStartMilliseconds);
+			LogFrameTimes(FString::Printf(TEXT("Round start %s, %d players, garbage collection"), Label, Players), Run->GarbageMilliseconds);
+			LogFrameTimes(FString::Printf(TEXT("Round start %s, %d players, game thread"), Label, Players), Run->FrameMilliseconds);
+
+			EndRound(Pool, *Run);
+
+			if (Run->IsPooled)
+			{
+				Pool->LogStats();
+				return false;
+			}
+
+			*Run = FRoundStartRun();
+			Run->IsPooled = true;
+
+			// Done while loading in a real game, so it isn't part of any round start
+			Pool->Prewarm(SampledClass, Players);
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			StartRound(SampledWorld, SampledClass, *Run);
+			return true;
+		}));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CrowdBenchmarkCommand(
+	TEXT("AL.Bench.Crowd"),
+	TEXT("Steps the crowd simulation with 100, 1000 and 5000 agents and logs the game-thread ms per step. Usage: AL.Bench.Crowd [Frames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunCrowdBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs ProjectileBenchmarkCommand(
+	TEXT("AL.Bench.Projectiles"),
+	TEXT("Fires sustained projectile volleys by spawning and then through the projectile pool and logs the ms per frame. Usage: AL.Bench.Projectiles <ClassPath> [Frames] [VolleySize]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunProjectileBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs PushBenchmarkCommand(
+	TEXT("AL.Bench.Push"),
+	TEXT("Spawns 500 to 2000 simulated cubes and pushes them with a blocking overlap, then through the push subsystem, and logs the ms per frame. Usage: AL.Bench.Push [BodyCount]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunPushBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs ServerLoadBenchmarkCommand(
+	TEXT("AL.Bench.ServerLoad"),
+	TEXT("Samples the server's tick time and per-player bandwidth with the connected clients and logs them. Usage: AL.Bench.ServerLoad [Seconds] [NetProfile]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunServerLoadBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs BotBenchmarkCommand(
+	TEXT("AL.Bench.Bots"),
+	TEXT("Runs 8, 32, 128... bot-driven characters up to MaxBots, measures each step and writes Saved/Profiling/BotBenchmark.json. Fails over the -ALBenchBudgetMs=, -ALBenchBudgetMsPerBot= and -ALBenchMemoryMBPerBot= budgets, and exits with an error code with -ALBenchExit. Usage: AL.Bench.Bots [MaxBots] [SecondsPerStep]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunBotBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs ProxyBenchmarkCommand(
+	TEXT("AL.Bench.Proxy"),
+	TEXT("Spawns full characters and then proxies and logs the memory, components and game-thread ms each costs per character. Usage: AL.Bench.Proxy [Count] [Frames] [ClassPath]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunProxyBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs TelemetryBenchmarkCommand(
+	TEXT("AL.Bench.Telemetry"),
+	TEXT("Records telemetry events every frame and logs the game-thread ns per event and how many were dropped. Usage: AL.Bench.Telemetry [EventsPerFrame] [Frames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunTelemetryBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs ArchetypeLoadBenchmarkCommand(
+	TEXT("AL.Bench.ArchetypeLoad"),
+	TEXT("Loads a character archetype's assets synchronously or through the streaming subsystem, then spawns characters of it, and logs the blocking ms. Usage: AL.Bench.ArchetypeLoad <ClassPath> [Sync|Async] [Count]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunArchetypeLoadBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs RoundStartBenchmarkCommand(
+	TEXT("AL.Bench.RoundStart"),
+	TEXT("Starts rounds of characters by spawning and destroying them, then through the character pool, and logs the blocking ms of each round start, the GC after it and the frame times. Usage: AL.Bench.RoundStart [Players] [Rounds] [ClassPath]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ALBenchmarks::RunRoundStartBenchmark));
@@ -0,0 +1,80 @@
+#include "ALCameraKickModifier.h"
+#include "Camera/CameraTypes.h"
+
+bool UALCameraKickModifier::ModifyCamera(float DeltaTime, FMinimalViewInfo& InOutPOV)
+{
+	Super::ModifyCamera(DeltaTime, InOutPOV);
+
+	float FOVOffset = 0.f;
+	FRotator ShakeRotation = FRotator::ZeroRotator;
+
+	for (FActiveKick& Kick : Kicks)
+	{
+		if (Kick.Scale <= 0.f)
+			continue;
+
+		Kick.Elapsed += DeltaTime;
+
+		const FALCameraKickParams& Params = Kick.Params;
+		if (Kick.Elapsed >= Params.Duration)
+		{
+			Kick.Scale = 0.f;
+			continue;
+		}
+
+		// Ramps up to the peak, then eases back out
+		const float Alpha = Kick.Elapsed / Params.Duration;
+		const float Envelope = Alpha < Params.RampUp
+			? Alpha / Params.RampUp
+			: FMath::Square(1.f - (Alpha - Params.RampUp) / (1.f - Params.RampUp));
+		const float Weight = Envelope * Kick.Scale;
+
+		FOVOffset += Params.FOVOffset * Weight;
+
+		const float Angle = 2.f * PI * Params.ShakeFrequency * Kick.Elapsed + Kick.Phase;
+		ShakeRotation.Pitch += Params.ShakeAmplitude * Weight * FMath::Sin(Angle);
+		ShakeRotation.Yaw += Params.ShakeAmplitude * Weight * FMath::Sin(Angle * 0.73f + 1.3f);
+	}
+
+	InOutPOV.FOV += FOVOffset;
+	InOutPOV.Rotation += ShakeRotation;
+
+	return false;
+}
+
+void UALCameraKickModifier::AddKick(const FALCameraKickParams& Params, float Scale)
+{
+	const float KickScale = Scale * Strength;
+	if (KickScale <= 0.f || Params.Duration <= 0.f)
+		return;
+
+	FActiveKick* Slot = &Kicks[0];
+	for (FActiveKick& Kick : Kicks)
+	{
+		if (Kick.Scale <= 0.f)
+		{
+			Slot = &Kick;
+			break;
+		}
+
+		if (Kick.Params.Duration - Kick.Elapsed < Slot->Params.Duration - Slot->Elapsed)
+			Slot = &Kick;
+	}
+
+	Slot->Params = Params;
+	Slot->Params.RampUp = FMath::Clamp(Params.RampUp, 0.01f, 0.99f);
+	Slot->Scale = KickScale;
+	Slot->Elapsed = 0.f;
+	Slot->Phase = FMath::FRandRange(0.f, 2.f * PI);
+}
+
+void UALCameraKickModifier::SetStrength(float NewStrength)
+{
+	Strength = FMath::Max(NewStrength, 0.f);
+
+	if (Strength > 0.f)
+		return;
+
+	for (FActiveKick& Kick : Kicks)
+		Kick.Scale = 0.f;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/CameraModifier.h"
+#include "ALCameraKickModifier.generated.h"
+
+USTRUCT(BlueprintType)
+struct FALCameraKickParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera Kick", meta = (ToolTip = "Degrees added to the field of view at the peak of the kick"))
+	float FOVOffset = 0.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera Kick", meta = (ToolTip = "Peak pitch and yaw shake in degrees"))
+	float ShakeAmplitude = 0.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera Kick", meta = (ClampMin = "0.0"))
+	float ShakeFrequency = 12.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera Kick", meta = (ClampMin = "0.01"))
+	float Duration = 0.3f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera Kick", meta = (ToolTip = "Part of the duration spent ramping up to the peak", ClampMin = "0.0", ClampMax = "1.0"))
+	float RampUp = 0.2f;
+};
+
+// Procedural FOV kick and shake, computed from a fixed set of slots instead of a UCameraShake object per event.
+// A new kick takes a free slot, or replaces the one closest to finishing. Strength scales every kick and 0 turns them off.
+UCLASS()
+class UALCameraKickModifier : public UCameraModifier
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ModifyCamera(float DeltaTime, FMinimalViewInfo& InOutPOV) override;
+
+	void AddKick(const FALCameraKickParams& Params, float Scale = 1.f);
+
+	UFUNCTION(BlueprintCallable, Category = "Camera Kick")
+	void SetStrength(float NewStrength);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Camera Kick")
+	float GetStrength() const { return Strength; }
+
+private:
+
+	struct FActiveKick
+	{
+		FALCameraKickParams Params;
+		float Scale = 0.f;
+		float Elapsed = 0.f;
+		float Phase = 0.f;
+	};
+
+	static const int32 MaxKicks = 4;
+	FActiveKick Kicks[MaxKicks];
+
+	float Strength = 1.f;
+};
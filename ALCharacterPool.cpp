@@ -0,0 +1,217 @@
+#include "ALCharacterPool.h"
+#include "AALCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/Controller.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogALCharacterPool, Log, All);
+
+void UALCharacterPoolSubsystem::Deinitialize()
+{
+	LogStats();
+
+	Pools.Reset();
+	ActiveCharacters.Reset();
+
+	Super::Deinitialize();
+}
+
+FALActorPool& UALCharacterPoolSubsystem::FindOrAddPool(UClass* CharacterClass)
+{
+	if (FALActorPool* Pool = Pools.Find(CharacterClass))
+		return *Pool;
+
+	return Pools.Add(CharacterClass);
+}
+
+void UALCharacterPoolSubsystem::SetCapacity(TSubclassOf<AALCharacter> CharacterClass, int32 Capacity)
+{
+	if (CharacterClass != nullptr)
+		FindOrAddPool(CharacterClass).Capacity = FMath::Max(Capacity, 0);
+}
+
+void UALCharacterPoolSubsystem::Prewarm(TSubclassOf<AALCharacter> CharacterClass, int32 Count)
+{
+	if (CharacterClass == nullptr)
+		return;
+
+	FALActorPool& Pool = FindOrAddPool(CharacterClass);
+	Pool.Capacity = FMath::Max(Pool.Capacity, Count);
+
+	const int32 NumToSpawn = FMath::Min(Count, Pool.Capacity) - Pool.FreeActors.Num() - Pool.NumInUse;
+	for (int32 i = 0; i < NumToSpawn; i++)
+	{
+		if (AALCharacter* Character = SpawnPooledCharacter(CharacterClass))
+			Pool.FreeActors.Add(Character);
+	}
+}
+
+AALCharacter* UALCharacterPoolSubsystem::SpawnPooledCharacter(UClass* CharacterClass)
+{
+	AALCharacter* Character = GetWorld()->SpawnActorDeferred<AALCharacter>(CharacterClass, FTransform::Identity, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (Character == nullptr)
+		return nullptr;
+
+	// Possessed by whoever acquires it, and without a camera stack until a local player does
+	Character->AutoPossessPlayer = EAutoReceiveInput::Disabled;
+	Character->AutoPossessAI = EAutoPossessAI::Disabled;
+	Character->SetProxyMode(true);
+	Character->FinishSpawning(FTransform::Identity);
+
+	// The pool decides when it goes away
+	Character->OnDestroyed.AddDynamic(this, &UALCharacterPoolSubsystem::HandlePooledCharacterDestroyed);
+
+	DeactivateCharacter(Character);
+	return Character;
+}
+
+AALCharacter* UALCharacterPoolSubsystem::AcquireCharacter(TSubclassOf<AALCharacter> CharacterClass, const FTransform& Transform)
+{
+	if (CharacterClass == nullptr)
+		return nullptr;
+
+	FALActorPool& Pool = FindOrAddPool(CharacterClass);
+
+	AALCharacter* Character = nullptr;
+	while (Character == nullptr && Pool.FreeActors.Num() > 0)
+		Character = Cast<AALCharacter>(Pool.FreeActors.Pop(false));
+
+	if (Character == nullptr)
+	{
+		Pool.Misses++;
+		Character = SpawnPooledCharacter(CharacterClass);
+		if (Character == nullptr)
+			return nullptr;
+	}
+
+	ActivateCharacter(Character, Transform);
+
+	Pool.NumInUse++;
+	Pool.PeakInUse = FMath::Max(Pool.PeakInUse, Pool.NumInUse);
+
+	ActiveCharacters.Add(Character);
+	return Character;
+}
+
+void UALCharacterPoolSubsystem::ReleaseCharacter(AALCharacter* Character)
+{
+	if (Character == nullptr || ActiveCharacters.Remove(Character) == 0)
+		return;
+
+	FALActorPool& Pool = FindOrAddPool(Character->GetClass());
+	Pool.NumInUse--;
+
+	if (Pool.FreeActors.Num() + Pool.NumInUse >= Pool.Capacity)
+	{
+		Character->OnDestroyed.RemoveDynamic(this, &UALCharacterPoolSubsystem::HandlePooledCharacterDestroyed);
+		Character->Destroy();
+		return;
+	}
+
+	DeactivateCharacter(Character);
+	Pool.FreeActors.Add(Character);
+}
+
+AALCharacter* UALCharacterPoolSubsystem::Respawn(AController* Controller, TSubclassOf<AALCharacter> CharacterClass, const FTransform& Transform)
+{
+	if (Controller == nullptr)
+		return nullptr;
+
+	if (AALCharacter* OldCharacter = Cast<AALCharacter>(Controller->GetPawn()))
+		ReleaseOrDestroy(OldCharacter);
+
+	AALCharacter* Character = AcquireCharacter(CharacterClass, Transform);
+	if (Character == nullptr)
+		return nullptr;
+
+	Controller->Possess(Character);
+
+	// Same as AGameModeBase::FinishRestartPlayer
+	Controller->ClientSetRotation(Character->GetActorRotation(), true);
+	Controller->SetControlRotation(FRotator(Transform.Rotator().Pitch, Transform.Rotator().Yaw, 0.f));
+	return Character;
+}
+
+void UALCharacterPoolSubsystem::ReleaseOrDestroy(AALCharacter* Character)
+{
+	if (Character == nullptr)
+		return;
+
+	UWorld* World = Character->GetWorld();
+	UALCharacterPoolSubsystem* PoolSubsystem = World ? World->GetSubsystem<UALCharacterPoolSubsystem>() : nullptr;
+
+	if (PoolSubsystem && PoolSubsystem->ActiveCharacters.Contains(Character))
+		PoolSubsystem->ReleaseCharacter(Character);
+	else
+		Character->Destroy();
+}
+
+void UALCharacterPoolSubsystem::HandlePooledCharacterDestroyed(AActor* Actor)
+{
+	// Something destroyed a pooled character directly, like a kill volume, so it just stops being counted
+	FALActorPool* Pool = Pools.Find(Actor->GetClass());
+	if (Pool == nullptr)
+		return;
+
+	if (ActiveCharacters.Remove(Cast<AALCharacter>(Actor)) > 0)
+		Pool->NumInUse--;
+	else
+		Pool->FreeActors.RemoveSwap(Actor);
+}
+
+void UALCharacterPoolSubsystem::DeactivateCharacter(AALCharacter* Character)
+{
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->UnPossess();
+
+		// AI controllers are spawned for their character. A player's controller stays with the player.
+		if (!Controller->IsPlayerController())
+			Controller->Destroy();
+	}
+
+	Character->SetActorHiddenInGame(true);
+	Character->SetActorEnableCollision(false);
+	Character->SetActorTickEnabled(false);
+	Character->GetCharacterMovement()->SetComponentTickEnabled(false);
+	Character->GetMesh()->SetComponentTickEnabled(false);
+
+	Character->OnReturnedToPool();
+}
+
+void UALCharacterPoolSubsystem::ActivateCharacter(AALCharacter* Character, const FTransform& Transform)
+{
+	Character->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Character->SetActorHiddenInGame(false);
+	Character->SetActorEnableCollision(true);
+	Character->SetActorTickEnabled(true);
+	Character->GetCharacterMovement()->SetComponentTickEnabled(true);
+	Character->GetMesh()->SetComponentTickEnabled(true);
+
+	Character->OnAcquiredFromPool();
+}
+
+FALActorPoolStats UALCharacterPoolSubsystem::GetStats(TSubclassOf<AALCharacter> CharacterClass) const
+{
+	FALActorPoolStats Stats;
+	if (const FALActorPool* Pool = Pools.Find(CharacterClass))
+	{
+		Stats.NumFree = Pool->FreeActors.Num();
+		Stats.NumInUse = Pool->NumInUse;
+		Stats.PeakInUse = Pool->PeakInUse;
+		Stats.Misses = Pool->Misses;
+		Stats.Capacity = Pool->Capacity;
+	}
+	return Stats;
+}
+
+void UALCharacterPoolSubsystem::LogStats() const
+{
+	for (const TPair<UClass*, FALActorPool>& Pair : Pools)
+	{
+		const FALActorPool& Pool = Pair.Value;
+		UE_LOG(LogALCharacterPool, Log, TEXT("%s: peak %d in use of %d capacity, %d misses, %d free"),
+			*GetNameSafe(Pair.Key), Pool.PeakInUse, Pool.Capacity, Pool.Misses, Pool.FreeActors.Num());
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ALProjectilePool.h"
+#include "ALCharacterPool.generated.h"
+
+class AALCharacter;
+class AController;
+
+// Keeps characters around between lives instead of destroying them, so a respawn or a round start doesn't run the constructor,
+// component registration and BeginPlay for every character at once, and GC doesn't have to clean up the old ones.
+// Released characters are unpossessed, hidden, stop ticking and colliding, and are reset with AALCharacter::ResetForReuse.
+// AI controllers of released characters are destroyed, player controllers stay with their player.
+// Game modes should call Respawn where they would spawn a new pawn for a controller, and ReleaseOrDestroy where they would destroy one.
+UCLASS()
+class UALCharacterPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	// Acquired characters come back unpossessed and in proxy mode. Possessing one picks its mode again.
+	UFUNCTION(BlueprintCallable, Category = "Character Pool")
+	AALCharacter* AcquireCharacter(TSubclassOf<AALCharacter> CharacterClass, const FTransform& Transform);
+
+	UFUNCTION(BlueprintCallable, Category = "Character Pool")
+	void ReleaseCharacter(AALCharacter* Character);
+
+	// Releases the controller's current character and possesses one from the pool at Transform instead
+	UFUNCTION(BlueprintCallable, Category = "Character Pool")
+	AALCharacter* Respawn(AController* Controller, TSubclassOf<AALCharacter> CharacterClass, const FTransform& Transform);
+
+	// Best called while loading, or between rounds, with the number of characters the next round needs
+	UFUNCTION(BlueprintCallable, Category = "Character Pool")
+	void Prewarm(TSubclassOf<AALCharacter> CharacterClass, int32 Count);
+
+	UFUNCTION(BlueprintCallable, Category = "Character Pool")
+	void SetCapacity(TSubclassOf<AALCharacter> CharacterClass, int32 Capacity);
+
+	FALActorPoolStats GetStats(TSubclassOf<AALCharacter> CharacterClass) const;
+	void LogStats() const;
+
+	// Releases pooled characters and destroys everything else
+	UFUNCTION(BlueprintCallable, Category = "Character Pool", meta = (DefaultToSelf = "Character"))
+	static void ReleaseOrDestroy(AALCharacter* Character);
+
+private:
+
+	FALActorPool& FindOrAddPool(UClass* CharacterClass);
+	AALCharacter* SpawnPooledCharacter(UClass* CharacterClass);
+
+	static void DeactivateCharacter(AALCharacter* Character);
+	static void ActivateCharacter(AALCharacter* Character, const FTransform& Transform);
+
+	UFUNCTION()
+	void HandlePooledCharacterDestroyed(AActor* Actor);
+
+	UPROPERTY()
+	TMap<UClass*, FALActorPool> Pools;
+
+	// Characters currently handed out
+	TSet<TWeakObjectPtr<AALCharacter>> ActiveCharacters;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ALCosmeticMovementState.generated.h"
+
+enum class EALCosmeticFlags : uint8
+{
+	None = 0,
+	OnOil = 1 << 0,
+	Sprinting = 1 << 1,
+	Dashing = 1 << 2,
+	Jumping = 1 << 3,
+	DoubleJumping = 1 << 4
+};
+ENUM_CLASS_FLAGS(EALCosmeticFlags);
+
+// The movement state simulated proxies need for their cosmetics, packed into a single byte on the wire.
+// Only the server writes it, and only marks it dirty when it actually changed, so the net driver never has to compare it.
+USTRUCT()
+struct FALCosmeticMovementState
+{
+	GENERATED_BODY()
+
+	static const int32 NumFlagBits = 5;
+	static const int32 NumJumpCountBits = 3;
+
+	EALCosmeticFlags Flags = EALCosmeticFlags::None;
+
+	// AALCharacter::JumpCounter, which only ever holds small whole numbers
+	uint8 JumpCount = 0;
+
+	bool HasFlag(EALCosmeticFlags Flag) const { return EnumHasAnyFlags(Flags, Flag); }
+
+	bool operator==(const FALCosmeticMovementState& Other) const { return Flags == Other.Flags && JumpCount == Other.JumpCount; }
+	bool operator!=(const FALCosmeticMovementState& Other) const { return !(*this == Other); }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		uint8 Packed = static_cast<uint8>(Flags) | (FMath::Min<uint8>(JumpCount, (1 << NumJumpCountBits) - 1) << NumFlagBits);
+		Ar.SerializeBits(&Packed, NumFlagBits + NumJumpCountBits);
+
+		if (Ar.IsLoading())
+		{
+			Flags = static_cast<EALCosmeticFlags>(Packed & ((1 << NumFlagBits) - 1));
+			JumpCount = Packed >> NumFlagBits;
+		}
+
+		bOutSuccess = true;
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FALCosmeticMovementState> : public TStructOpsTypeTraitsBase2<FALCosmeticMovementState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
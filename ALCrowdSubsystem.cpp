@@ -0,0 +1,461 @@
+#include "ALCrowdSubsystem.h"
+#include "AALCharacter.h"
+#include "ALAssetStreamingSubsystem.h"
+#include "ALCharacterPool.h"
+#include "Components/ALCharacterMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Async/ParallelFor.h"
+#include "Components/ALSlipperyOil.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+
+void UALCrowdSubsystem::Deinitialize()
+{
+	RemoveAllAgents();
+	PromotedCharacters.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UALCrowdSubsystem::IsTickable() const
+{
+	return !IsTemplate() && (Locomotion.Num() > 0 || PromotedCharacters.Num() > 0);
+}
+
+TStatId UALCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UALCrowdSubsystem, STATGROUP_Tickables);
+}
+
+void UALCrowdSubsystem::Tick(float DeltaTime)
+{
+	if (!HasOilPatches)
+		RefreshOilPatches();
+
+	Simulate(DeltaTime);
+
+	if (PromotionEnabled)
+	{
+		PromoteAgents();
+		DemoteCharacters();
+	}
+}
+
+void UALCrowdSubsystem::SetAgentCharacterClass(TSubclassOf<AALCharacter> CharacterClass)
+{
+	AgentCharacterClass = CharacterClass;
+	if (AgentCharacterClass == nullptr)
+		return;
+
+	// Agents are promoted to this class near the player, so its assets should be in memory well before then
+	if (UALAssetStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UALAssetStreamingSubsystem>())
+		Streaming->PreloadArchetype(AgentCharacterClass);
+
+	const AALCharacter* Defaults = AgentCharacterClass->GetDefaultObject<AALCharacter>();
+	const UCharacterMovementComponent* MovementDefaults = Defaults->GetCharacterMovement();
+
+	Params.WalkSpeed = MovementDefaults->MaxWalkSpeed;
+	Params.JumpZVelocity = MovementDefaults->JumpZVelocity;
+	Params.BrakingDeceleration = MovementDefaults->BrakingDecelerationWalking;
+	Params.SprintSpeed = Defaults->SprintSpeed;
+	Params.GlidSpeed = Defaults->GlidSpeed;
+	Params.OilTimer = Defaults->GetOilTimer();
+	Params.MaxJumpCounter = Defaults->MaxJumpCounter;
+	Params.MaxDashCounter = Defaults->GetMaxDashCounter();
+	Params.LaunchVelocity = Defaults->LaunchVelocity;
+	Params.DashVelocity = Defaults->DashVelocity;
+	Params.DashDistance = Defaults->DashDistance;
+	Params.CapsuleHalfHeight = Defaults->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	if (const UALCharacterMovementComponent* ALMovementDefaults = Cast<UALCharacterMovementComponent>(MovementDefaults))
+		Params.DashExitSpeed = ALMovementDefaults->DashExitSpeed;
+}
+
+int32 UALCrowdSubsystem::AddAgent(const FVector& Location)
+{
+	const int32 Index = Locomotion.Num();
+
+	FALCrowdLocomotionFragment& NewLocomotion = Locomotion.AddDefaulted_GetRef();
+	NewLocomotion.Location = Location;
+	NewLocomotion.Velocity = FVector::ZeroVector;
+	NewLocomotion.GroundZ = Location.Z;
+
+	FALCrowdMovementFragment& NewMovement = Movement.AddZeroed_GetRef();
+	NewMovement.MaxWalkSpeed = Params.WalkSpeed;
+
+	FALCrowdIntentFragment& NewIntent = Intent.AddZeroed_GetRef();
+	NewIntent.Random.Initialize(Index * 7919 + 1);
+
+	return Index;
+}
+
+void UALCrowdSubsystem::SpawnAgents(int32 Count, const FVector& Center, float Radius)
+{
+	Locomotion.Reserve(Locomotion.Num() + Count);
+	Movement.Reserve(Movement.Num() + Count);
+	Intent.Reserve(Intent.Num() + Count);
+
+	FRandomStream Random(Count);
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector2D Offset = FVector2D(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f)) * Radius;
+		AddAgent(Center + FVector(Offset, 0.f));
+	}
+}
+
+void UALCrowdSubsystem::RemoveAllAgents()
+{
+	Locomotion.Reset();
+	Movement.Reset();
+	Intent.Reset();
+}
+
+void UALCrowdSubsystem::RemoveAgentAt(int32 Index)
+{
+	Locomotion.RemoveAtSwap(Index, 1, false);
+	Movement.RemoveAtSwap(Index, 1, false);
+	Intent.RemoveAtSwap(Index, 1, false);
+}
+
+void UALCrowdSubsystem::RefreshOilPatches()
+{
+	OilPatches.Reset();
+	HasOilPatches = true;
+
+	// Only done once per level, so the component scan is fine here
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		if (It->FindComponentByClass<UALSlipperyOil>())
+			OilPatches.Add(It->GetComponentsBoundingBox());
+	}
+}
+
+void UALCrowdSubsystem::GatherPlayerLocations()
+{
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+			PlayerLocations.Add(Pawn->GetActorLocation());
+	}
+}
+
+void UALCrowdSubsystem::Simulate(float DeltaSeconds)
+{
+	// Demotion reads the player locations too, so they're gathered even once every agent has been promoted
+	GatherPlayerLocations();
+
+	const int32 NumAgents = Locomotion.Num();
+	if (NumAgents == 0)
+		return;
+
+	SimulationTime += DeltaSeconds;
+
+	FALCrowdStepContext Context;
+	Context.DeltaSeconds = DeltaSeconds;
+	Context.WorldTime = SimulationTime;
+	Context.PromoteRadiusSquared = PromotionEnabled ? FMath::Square(PromoteRadius) : -1.f;
+	Context.Params = &Params;
+	Context.OilPatches = &OilPatches;
+	Context.PlayerLocations = &PlayerLocations;
+
+	FALCrowdLocomotionFragment* Locomotions = Locomotion.GetData();
+	FALCrowdMovementFragment* Movements = Movement.GetData();
+	FALCrowdIntentFragment* Intents = Intent.GetData();
+
+	// Agents never read each other, so each chunk runs every processor in order on its own range while it's still in cache.
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumAgents, FMath::Max(ChunkSize, 1));
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		const int32 Begin = Chunk * ChunkSize;
+		const int32 End = FMath::Min(Begin + ChunkSize, NumAgents);
+
+		ProcessIntent(Context, Begin, End, Intents, Movements);
+		ProcessActions(Context, Begin, End, Intents, Movements, Locomotions);
+		ProcessOil(Context, Begin, End, Movements, Locomotions);
+		ProcessSliding(Context, Begin, End, Movements);
+		ProcessLocomotion(Context, Begin, End, Locomotions, Movements, Intents);
+		ProcessPromotion(Context, Begin, End, Movements, Locomotions);
+	});
+}
+
+void UALCrowdSubsystem::ProcessIntent(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdIntentFragment* Intents, const FALCrowdMovementFragment* Movements)
+{
+	for (int32 i = Begin; i < End; i++)
+	{
+		FALCrowdIntentFragment& AgentIntent = Intents[i];
+		if (Context.WorldTime < AgentIntent.NextDecisionTime)
+			continue;
+
+		FRandomStream& Random = AgentIntent.Random;
+		const float Angle = Random.FRandRange(0.f, 2.f * PI);
+
+		AgentIntent.MoveDirection = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle));
+		AgentIntent.WantsSprint = Random.FRand() < 0.4f;
+		AgentIntent.WantsJump = Random.FRand() < 0.2f;
+		// Only worth deciding to dash while in the air, same as the player
+		AgentIntent.WantsDash = Movements[i].IsAirborne && Random.FRand() < 0.3f;
+		AgentIntent.NextDecisionTime = Context.WorldTime + Random.FRandRange(0.5f, 2.f);
+	}
+}
+
+void UALCrowdSubsystem::ProcessActions(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdIntentFragment* Intents, FALCrowdMovementFragment* Movements, FALCrowdLocomotionFragment* Locomotions)
+{
+	const FALCrowdAgentParams& P = *Context.Params;
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		FALCrowdIntentFragment& AgentIntent = Intents[i];
+		FALCrowdMovementFragment& AgentMovement = Movements[i];
+		FALCrowdLocomotionFragment& AgentLocomotion = Locomotions[i];
+
+		AgentMovement.IsSprinting = AgentIntent.WantsSprint;
+
+		if (AgentIntent.WantsJump)
+		{
+			AgentIntent.WantsJump = false;
+
+			if (!AgentMovement.IsAirborne)
+			{
+				AgentLocomotion.Velocity.Z = P.JumpZVelocity;
+				AgentMovement.IsAirborne = true;
+			}
+			else if (ALMovementRules::CanDoubleJump(AgentMovement.IsAirborne, AgentMovement.JumpCounter, P.MaxJumpCounter))
+			{
+				AgentLocomotion.Velocity.Z = P.LaunchVelocity;
+				AgentMovement.JumpCounter++;
+			}
+		}
+
+		if (AgentIntent.WantsDash)
+		{
+			AgentIntent.WantsDash = false;
+
+			if (ALMovementRules::CanDash(AgentMovement.IsAirborne, AgentMovement.IsOnOil, AgentMovement.DashCounter, P.MaxDashCounter))
+			{
+				AgentMovement.DashDirection = AgentIntent.MoveDirection.GetSafeNormal();
+				AgentMovement.DashElapsed = 0.f;
+				AgentMovement.DashDuration = P.DashVelocity > 0.f ? 2.f * P.DashDistance / P.DashVelocity : 0.f;
+				AgentLocomotion.Velocity = FVector(AgentMovement.DashDirection * P.DashVelocity, 0.f);
+				AgentMovement.DashCounter++;
+			}
+		}
+	}
+}
+
+void UALCrowdSubsystem::ProcessOil(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdMovementFragment* Movements, const FALCrowdLocomotionFragment* Locomotions)
+{
+	const TArray<FBox>& Patches = *Context.OilPatches;
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		FALCrowdMovementFragment& AgentMovement = Movements[i];
+
+		bool IsOnOil = AgentMovement.IsOnOil;
+		float OilTime = AgentMovement.OilTime;
+
+		// Like the character's floor, the surface is only looked at on the ground and is remembered through a jump
+		if (!AgentMovement.IsAirborne)
+		{
+			bool IsOnOilFloor = false;
+			for (const FBox& Patch : Patches)
+			{
+				if (Patch.IsInsideOrOn(Locomotions[i].Location))
+				{
+					IsOnOilFloor = true;
+					break;
+				}
+			}
+			AgentMovement.IsOnOilFloor = IsOnOilFloor;
+		}
+
+		// Same as AALCharacter: slippery while on the oil, then counts down OilTimer after stepping off
+		if (AgentMovement.IsOnOilFloor)
+		{
+			IsOnOil = true;
+			OilTime = 0.f;
+		}
+		else
+			ALMovementRules::TickOilTimer(IsOnOil, OilTime, Context.Params->OilTimer, Context.DeltaSeconds);
+
+		AgentMovement.IsOnOil = IsOnOil;
+		AgentMovement.OilTime = OilTime;
+	}
+}
+
+void UALCrowdSubsystem::ProcessSliding(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdMovementFragment* Movements)
+{
+	const FALCrowdAgentParams& P = *Context.Params;
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		FALCrowdMovementFragment& AgentMovement = Movements[i];
+		AgentMovement.MaxWalkSpeed = ALMovementRules::SprintWalkSpeed(P.WalkSpeed, AgentMovement.IsOnOil, AgentMovement.IsSprinting, P.SprintSpeed, P.GlidSpeed);
+	}
+}
+
+void UALCrowdSubsystem::ProcessDash(const FALCrowdAgentParams& P, float DeltaSeconds, FALCrowdLocomotionFragment& AgentLocomotion, FALCrowdMovementFragment& AgentMovement)
+{
+	// Same curve as UALCharacterMovementComponent::PhysDash: distance covered follows 1 - (1 - t)^2 over 2 * DashDistance / DashVelocity
+	auto DashCurve = [](float Alpha) { return 1.f - FMath::Square(1.f - Alpha); };
+
+	const float PrevAlpha = AgentMovement.DashElapsed / AgentMovement.DashDuration;
+	AgentMovement.DashElapsed = FMath::Min(AgentMovement.DashElapsed + DeltaSeconds, AgentMovement.DashDuration);
+	const float Alpha = AgentMovement.DashElapsed / AgentMovement.DashDuration;
+
+	const float Distance = P.DashDistance * (DashCurve(Alpha) - DashCurve(PrevAlpha));
+	AgentLocomotion.Location += FVector(AgentMovement.DashDirection * Distance, 0.f);
+
+	if (Alpha < 1.f)
+	{
+		AgentLocomotion.Velocity = FVector(AgentMovement.DashDirection * (2.f * P.DashDistance / AgentMovement.DashDuration) * (1.f - Alpha), 0.f);
+		return;
+	}
+
+	// The character falls on at DashExitSpeed once the dash is over
+	AgentLocomotion.Velocity = FVector(AgentMovement.DashDirection * P.DashExitSpeed, 0.f);
+	AgentMovement.DashDuration = 0.f;
+}
+
+void UALCrowdSubsystem::ProcessLocomotion(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdLocomotionFragment* Locomotions, FALCrowdMovementFragment* Movements, const FALCrowdIntentFragment* Intents)
+{
+	const FALCrowdAgentParams& P = *Context.Params;
+	const float DeltaSeconds = Context.DeltaSeconds;
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		FALCrowdLocomotionFragment& AgentLocomotion = Locomotions[i];
+		FALCrowdMovementFragment& AgentMovement = Movements[i];
+
+		if (AgentMovement.DashDuration > 0.f)
+		{
+			ProcessDash(P, DeltaSeconds, AgentLocomotion, AgentMovement);
+			continue;
+		}
+
+		// Horizontal speed eases towards the walk speed, which also bleeds off a dash over a few frames
+		const FVector2D TargetVelocity = Intents[i].MoveDirection * AgentMovement.MaxWalkSpeed;
+		FVector2D Velocity(AgentLocomotion.Velocity);
+		const FVector2D Delta = TargetVelocity - Velocity;
+		const float MaxChange = P.BrakingDeceleration * DeltaSeconds;
+		Velocity += Delta.SizeSquared() > FMath::Square(MaxChange) ? Delta.GetSafeNormal() * MaxChange : Delta;
+
+		AgentLocomotion.Velocity.X = Velocity.X;
+		AgentLocomotion.Velocity.Y = Velocity.Y;
+
+		if (AgentMovement.IsAirborne)
+			AgentLocomotion.Velocity.Z += P.GravityZ * DeltaSeconds;
+
+		AgentLocomotion.Location += AgentLocomotion.Velocity * DeltaSeconds;
+
+		if (AgentMovement.IsAirborne && AgentLocomotion.Location.Z <= AgentLocomotion.GroundZ)
+		{
+			AgentLocomotion.Location.Z = AgentLocomotion.GroundZ;
+			AgentLocomotion.Velocity.Z = 0.f;
+			AgentMovement.IsAirborne = false;
+			ALMovementRules::ResetOnLanding(AgentMovement.JumpCounter, AgentMovement.DashCounter);
+		}
+	}
+}
+
+void UALCrowdSubsystem::ProcessPromotion(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdMovementFragment* Movements, const FALCrowdLocomotionFragment* Locomotions)
+{
+	const TArray<FVector>& Players = *Context.PlayerLocations;
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		bool WantsPromotion = false;
+		for (const FVector& PlayerLocation : Players)
+		{
+			if (FVector::DistSquared(PlayerLocation, Locomotions[i].Location) < Context.PromoteRadiusSquared)
+			{
+				WantsPromotion = true;
+				break;
+			}
+		}
+		Movements[i].WantsPromotion = WantsPromotion;
+	}
+}
+
+void UALCrowdSubsystem::PromoteAgents()
+{
+	// Agents walk in and out of range all the time, so their characters come from the pool and go back to it when demoted
+	UALCharacterPoolSubsystem* CharacterPool = GetWorld()->GetSubsystem<UALCharacterPoolSubsystem>();
+	if (AgentCharacterClass == nullptr || CharacterPool == nullptr)
+		return;
+
+	// Backwards so RemoveAtSwap only moves agents that have already been checked
+	for (int32 i = Locomotion.Num() - 1; i >= 0; i--)
+	{
+		if (!Movement[i].WantsPromotion)
+			continue;
+
+		const FALCrowdLocomotionFragment& AgentLocomotion = Locomotion[i];
+		const FALCrowdMovementFragment& AgentMovement = Movement[i];
+		const FRotator Rotation = FVector(Intent[i].MoveDirection, 0.f).Rotation();
+
+		const FVector Location = AgentLocomotion.Location + FVector(0.f, 0.f, Params.CapsuleHalfHeight);
+		AALCharacter* Character = CharacterPool->AcquireCharacter(AgentCharacterClass, FTransform(Rotation, Location));
+		if (Character == nullptr)
+			continue;
+
+		// Agents are AI. Pooled characters never possess themselves, so the AI controller is spawned here.
+		Character->SpawnDefaultController();
+
+		FALMovementRuleState State;
+		State.IsOnOil = AgentMovement.IsOnOil;
+		State.OilTime = AgentMovement.OilTime;
+		State.JumpCounter = AgentMovement.JumpCounter;
+		State.DashCounter = AgentMovement.DashCounter;
+		Character->SetMovementRuleState(State);
+		Character->GetCharacterMovement()->Velocity = AgentLocomotion.Velocity;
+
+		PromotedCharacters.Add(Character);
+		RemoveAgentAt(i);
+	}
+}
+
+void UALCrowdSubsystem::DemoteCharacters()
+{
+	const float DemoteRadiusSquared = FMath::Square(DemoteRadius);
+
+	for (int32 i = PromotedCharacters.Num() - 1; i >= 0; i--)
+	{
+		AALCharacter* Character = PromotedCharacters[i];
+		if (Character == nullptr || Character->IsPendingKill())
+		{
+			PromotedCharacters.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		const FVector Location = Character->GetActorLocation();
+
+		bool IsNearPlayer = false;
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			if (FVector::DistSquared(PlayerLocation, Location) < DemoteRadiusSquared)
+			{
+				IsNearPlayer = true;
+				break;
+			}
+		}
+
+		// Agents take their ground height from where they're added, so wait until the character has landed
+		if (IsNearPlayer || Character->GetCharacterMovement()->IsFalling())
+			continue;
+
+		const FALMovementRuleState State = Character->GetMovementRuleState();
+		const int32 Index = AddAgent(Location - FVector(0.f, 0.f, Params.CapsuleHalfHeight));
+		Locomotion[Index].Velocity = Character->GetVelocity();
+		Movement[Index].IsOnOil = State.IsOnOil;
+		Movement[Index].OilTime = State.OilTime;
+		Movement[Index].JumpCounter = State.JumpCounter;
+		Movement[Index].DashCounter = State.DashCounter;
+
+		UALCharacterPoolSubsystem::ReleaseOrDestroy(Character);
+		PromotedCharacters.RemoveAtSwap(i, 1, false);
+	}
+}
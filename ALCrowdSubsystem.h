@@ -0,0 +1,162 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ALMovementRules.h"
+#include "ALCrowdSubsystem.generated.h"
+
+class AALCharacter;
+
+// Tuning shared by every crowd agent. Read from the AALCharacter class default object so agents use the same numbers the designers set.
+struct FALCrowdAgentParams
+{
+	float WalkSpeed = 600.f;
+	float SprintSpeed = 1200.f;
+	float GlidSpeed = 2000.f;
+	float OilTimer = 1.5f;
+	float MaxJumpCounter = 1.f;
+	float MaxDashCounter = 1.f;
+	float JumpZVelocity = 420.f;
+	float LaunchVelocity = 500.f;
+	float DashVelocity = 10000.f;
+	float DashDistance = 800.f;
+	float DashExitSpeed = 600.f;
+	float GravityZ = -980.f;
+	float BrakingDeceleration = 2048.f;
+	// Agents stand on their ground point, characters are placed by their capsule centre
+	float CapsuleHalfHeight = 88.f;
+};
+
+// Fragments. Each one is stored in its own array, so a processor only walks the memory it actually reads.
+struct FALCrowdLocomotionFragment
+{
+	FVector Location;
+	FVector Velocity;
+	float GroundZ;
+};
+
+struct FALCrowdMovementFragment
+{
+	float MaxWalkSpeed;
+	float JumpCounter;
+	float DashCounter;
+	float OilTime;
+	// Dash in progress, following the same distance curve as the character's. DashDuration is zero when not dashing
+	FVector2D DashDirection;
+	float DashElapsed;
+	float DashDuration;
+	uint8 IsOnOil : 1;
+	uint8 IsOnOilFloor : 1;
+	uint8 IsSprinting : 1;
+	uint8 IsAirborne : 1;
+	uint8 WantsPromotion : 1;
+};
+
+struct FALCrowdIntentFragment
+{
+	FVector2D MoveDirection;
+	float NextDecisionTime;
+	FRandomStream Random;
+	uint8 WantsSprint : 1;
+	uint8 WantsJump : 1;
+	uint8 WantsDash : 1;
+};
+
+// Read-only data every processor gets for a simulation step.
+struct FALCrowdStepContext
+{
+	float DeltaSeconds;
+	float WorldTime;
+	float PromoteRadiusSquared;
+	const FALCrowdAgentParams* Params;
+	const TArray<FBox>* OilPatches;
+	const TArray<FVector>* PlayerLocations;
+};
+
+// Runs the AALCharacter movement rules (oil countdown, sliding speed, jump and dash counters) for crowds of AI agents without
+// spawning a ticking ACharacter for each one. Agents are plain data stepped in parallel on worker threads. Agents that come within
+// PromoteRadius of a player are turned into a full AALCharacter, and turned back into an agent once they're past DemoteRadius.
+UCLASS()
+class UALCrowdSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	void SetAgentCharacterClass(TSubclassOf<AALCharacter> CharacterClass);
+
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	int32 AddAgent(const FVector& Location);
+
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	void SpawnAgents(int32 Count, const FVector& Center, float Radius);
+
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	void RemoveAllAgents();
+
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	int32 GetNumAgents() const { return Locomotion.Num(); }
+
+	// Collects the bounds of every UALSlipperyOil in the world. Call again if oil is spawned at runtime.
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	void RefreshOilPatches();
+
+	// Steps every agent once. Called from Tick, and directly by the crowd benchmark.
+	void Simulate(float DeltaSeconds);
+
+	UPROPERTY(BlueprintReadWrite, Category = "Crowd")
+	float PromoteRadius = 2500.f;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Crowd")
+	float DemoteRadius = 3500.f;
+
+	// Turned off by the benchmark so nothing gets spawned while measuring
+	UPROPERTY(BlueprintReadWrite, Category = "Crowd")
+	bool PromotionEnabled = true;
+
+	// Agents per worker task
+	UPROPERTY(BlueprintReadWrite, Category = "Crowd")
+	int32 ChunkSize = 256;
+
+private:
+
+	UPROPERTY()
+	TSubclassOf<AALCharacter> AgentCharacterClass;
+
+	UPROPERTY()
+	TArray<AALCharacter*> PromotedCharacters;
+
+	FALCrowdAgentParams Params;
+
+	TArray<FALCrowdLocomotionFragment> Locomotion;
+	TArray<FALCrowdMovementFragment> Movement;
+	TArray<FALCrowdIntentFragment> Intent;
+
+	TArray<FBox> OilPatches;
+	TArray<FVector> PlayerLocations;
+
+	bool HasOilPatches = false;
+	float SimulationTime = 0.f;
+
+	void RemoveAgentAt(int32 Index);
+	void GatherPlayerLocations();
+	void PromoteAgents();
+	void DemoteCharacters();
+
+	// Processors. Each one works on the agents in [Begin, End) and never looks at any other agent.
+	static void ProcessIntent(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdIntentFragment* Intents, const FALCrowdMovementFragment* Movements);
+	static void ProcessActions(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdIntentFragment* Intents, FALCrowdMovementFragment* Movements, FALCrowdLocomotionFragment* Locomotions);
+	static void ProcessOil(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdMovementFragment* Movements, const FALCrowdLocomotionFragment* Locomotions);
+	static void ProcessSliding(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdMovementFragment* Movements);
+	static void ProcessLocomotion(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdLocomotionFragment* Locomotions, FALCrowdMovementFragment* Movements, const FALCrowdIntentFragment* Intents);
+	static void ProcessDash(const FALCrowdAgentParams& P, float DeltaSeconds, FALCrowdLocomotionFragment& AgentLocomotion, FALCrowdMovementFragment& AgentMovement);
+	static void ProcessPromotion(const FALCrowdStepContext& Context, int32 Begin, int32 End, FALCrowdMovementFragment* Movements, const FALCrowdLocomotionFragment* Locomotions);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Splits frame times of any length into steps of the same length, so whatever is simulated with it comes out the same at any frame rate.
+// Time short of a whole step is carried over to the next frame. GetAlpha says how far into the next step that time is, for drawing
+// the simulated thing part way between its last two steps.
+struct FALFixedStep
+{
+	// Time carried over from earlier frames, always less than one step
+	float Remainder = 0.f;
+
+	FORCEINLINE void Reset() { Remainder = 0.f; }
+
+	// Adds DeltaSeconds and returns the number of steps to run now. Past MaxSteps the rest of the time is dropped, so a long
+	// hitch slows the simulation down for a frame instead of running a burst of steps.
+	FORCEINLINE int32 Advance(float DeltaSeconds, float StepSeconds, int32 MaxSteps)
+	{
+		Remainder += DeltaSeconds;
+
+		const int32 NumSteps = FMath::Min(FMath::FloorToInt(Remainder / StepSeconds), MaxSteps);
+		Remainder -= NumSteps * StepSeconds;
+
+		if (Remainder >= StepSeconds)
+			Remainder = 0.f;
+
+		return NumSteps;
+	}
+
+	FORCEINLINE float GetAlpha(float StepSeconds) const
+	{
+		return FMath::Clamp(Remainder / StepSeconds, 0.f, 1.f);
+	}
+};
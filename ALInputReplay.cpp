@@ -0,0 +1,268 @@
+#include "ALInputReplay.h"
+#include "AALCharacter.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/Crc.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogALInputReplay, Log, All);
+
+namespace ALInputFile
+{
+	static const uint32 Magic = 0x52494C41; // "ALIR"
+	static const uint16 Version = 1;
+
+	// Frames are stored as packed deltas, and only axes carry a value
+	static bool Serialize(FArchive& Ar, TArray<FALRecordedInput>& Inputs, float& FixedStep)
+	{
+		uint32 FileMagic = Magic;
+		uint16 FileVersion = Version;
+		Ar << FileMagic << FileVersion;
+
+		if (FileMagic != Magic || FileVersion != Version)
+			return false;
+
+		Ar << FixedStep;
+
+		int32 NumInputs = Inputs.Num();
+		Ar << NumInputs;
+
+		if (Ar.IsLoading())
+		{
+			if (NumInputs < 0 || NumInputs > Ar.TotalSize())
+				return false;
+
+			Inputs.SetNumUninitialized(NumInputs);
+		}
+
+		uint32 PreviousFrame = 0;
+		for (FALRecordedInput& Input : Inputs)
+		{
+			uint32 FrameDelta = Input.Frame - PreviousFrame;
+			Ar.SerializeIntPacked(FrameDelta);
+			Input.Frame = PreviousFrame + FrameDelta;
+			PreviousFrame = Input.Frame;
+
+			Ar << Input.Code;
+
+			// Used as an index when replayed, so a corrupt or newer recording is rejected here
+			if (Ar.IsLoading())
+			{
+				const bool IsAxis = (Input.Code & FALRecordedInput::AxisFlag) != 0;
+				const uint8 Index = Input.Code & ~FALRecordedInput::AxisFlag;
+				if (Index >= (IsAxis ? static_cast<uint8>(EALInputAxis::Count) : static_cast<uint8>(EALInputAction::Count)))
+					return false;
+			}
+
+			if (Input.Code & FALRecordedInput::AxisFlag)
+				Ar << Input.Value;
+			else
+				Input.Value = 0.f;
+		}
+
+		return !Ar.IsError();
+	}
+}
+
+FALInputRecorder::FALInputRecorder(const FString& InFilename)
+	: Filename(InFilename)
+	, StartFrame(GFrameCounter)
+{
+	for (float& Value : AxisValues)
+		Value = 0.f;
+
+	UE_LOG(LogALInputReplay, Display, TEXT("Recording input to %s"), *Filename);
+}
+
+FALInputRecorder::~FALInputRecorder()
+{
+	float FixedStep = FApp::UseFixedTimeStep() ? FApp::GetFixedDeltaTime() : 0.f;
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	ALInputFile::Serialize(Writer, Inputs, FixedStep);
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Filename))
+	{
+		UE_LOG(LogALInputReplay, Error, TEXT("Couldn't save input recording to %s"), *Filename);
+		return;
+	}
+
+	UE_LOG(LogALInputReplay, Display, TEXT("Saved %d inputs over %u frames to %s (%d bytes)"), Inputs.Num(), GetCurrentFrame(), *Filename, Bytes.Num());
+}
+
+uint32 FALInputRecorder::GetCurrentFrame() const
+{
+	return static_cast<uint32>(GFrameCounter - StartFrame);
+}
+
+void FALInputRecorder::RecordAction(EALInputAction Action)
+{
+	Inputs.Add({ GetCurrentFrame(), static_cast<uint8>(Action), 0.f });
+}
+
+void FALInputRecorder::RecordAxis(EALInputAxis Axis, float Value)
+{
+	float& LastValue = AxisValues[static_cast<int32>(Axis)];
+	if (LastValue == Value)
+		return;
+
+	LastValue = Value;
+	Inputs.Add({ GetCurrentFrame(), static_cast<uint8>(static_cast<uint8>(Axis) | FALRecordedInput::AxisFlag), Value });
+}
+
+FALInputReplayer::FALInputReplayer(AALCharacter* InCharacter, const FString& Filename)
+	: Character(InCharacter)
+{
+	for (float& Value : AxisValues)
+		Value = 0.f;
+
+	ReportFilename = FPaths::ProjectSavedDir() / TEXT("Profiling") / FPaths::GetBaseFilename(Filename) + TEXT("_Replay.csv");
+	FParse::Value(FCommandLine::Get(), TEXT("ALReplayReport="), ReportFilename);
+	ExitWhenFinished = FParse::Param(FCommandLine::Get(), TEXT("ALReplayExit"));
+
+	float FixedStep = 0.f;
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		Fail(FString::Printf(TEXT("Couldn't read input recording %s"), *Filename));
+		return;
+	}
+
+	FMemoryReader Reader(Bytes);
+	if (!ALInputFile::Serialize(Reader, Inputs, FixedStep))
+	{
+		Inputs.Reset();
+		Fail(FString::Printf(TEXT("%s isn't a valid input recording, or holds inputs this build doesn't know"), *Filename));
+		return;
+	}
+
+	// Recordings made with a variable step are replayed at 60 Hz. Either way every replay of a file runs the same steps.
+	FParse::Value(FCommandLine::Get(), TEXT("ALReplayStep="), FixedStep);
+	if (FixedStep <= 0.f)
+		FixedStep = 1.f / 60.f;
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedStep);
+
+	// A second of idle frames after the last input, so landings and timers settle before the checksum is taken
+	LastFrame = (Inputs.Num() > 0 ? Inputs.Last().Frame : 0) + FMath::CeilToInt(1.f / FixedStep);
+	FrameMilliseconds.Reserve(LastFrame + 1);
+
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddRaw(this, &FALInputReplayer::HandleWorldPreActorTick);
+
+	UE_LOG(LogALInputReplay, Display, TEXT("Replaying %d inputs over %u frames from %s at %.4f s per step"), Inputs.Num(), LastFrame, *Filename, FixedStep);
+}
+
+FALInputReplayer::~FALInputReplayer()
+{
+	Abort(TEXT("the replayer was destroyed"));
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+}
+
+void FALInputReplayer::Abort(const TCHAR* Reason)
+{
+	if (Finished)
+		return;
+
+	UE_LOG(LogALInputReplay, Error, TEXT("Replay aborted at frame %u of %u: %s"), Frame, LastFrame, Reason);
+	Aborted = true;
+	Finish();
+}
+
+void FALInputReplayer::Fail(const FString& Error)
+{
+	UE_LOG(LogALInputReplay, Error, TEXT("%s"), *Error);
+	Finished = true;
+
+	if (ExitWhenFinished)
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+}
+
+void FALInputReplayer::HandleWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	AALCharacter* ReplayCharacter = Character.Get();
+	if (ReplayCharacter == nullptr)
+	{
+		Abort(TEXT("the character is gone"));
+		return;
+	}
+
+	if (World != ReplayCharacter->GetWorld() || Finished)
+		return;
+
+	const double Now = FPlatformTime::Seconds();
+	if (LastFrameTime > 0.0)
+		FrameMilliseconds.Add(static_cast<float>((Now - LastFrameTime) * 1000.0));
+	LastFrameTime = Now;
+
+	for (; NextInput < Inputs.Num() && Inputs[NextInput].Frame <= Frame; NextInput++)
+	{
+		const FALRecordedInput& Input = Inputs[NextInput];
+
+		if (Input.Code & FALRecordedInput::AxisFlag)
+			AxisValues[Input.Code & ~FALRecordedInput::AxisFlag] = Input.Value;
+		else
+			ReplayCharacter->DispatchInputAction(static_cast<EALInputAction>(Input.Code));
+	}
+
+	// Bound axes are called every frame whether they changed or not, so the replay does the same
+	for (int32 Axis = 0; Axis < static_cast<int32>(EALInputAxis::Count); Axis++)
+		ReplayCharacter->DispatchInputAxis(AxisValues[Axis], static_cast<EALInputAxis>(Axis));
+
+	if (++Frame > LastFrame)
+		Finish();
+}
+
+void FALInputReplayer::Finish()
+{
+	if (Finished)
+		return;
+
+	Finished = true;
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+
+	FString Report = TEXT("Frame,FrameMs\n");
+	double TotalMilliseconds = 0.0;
+	for (int32 i = 0; i < FrameMilliseconds.Num(); i++)
+	{
+		Report += FString::Printf(TEXT("%d,%.4f\n"), i, FrameMilliseconds[i]);
+		TotalMilliseconds += FrameMilliseconds[i];
+	}
+
+	const AALCharacter* ReplayCharacter = Character.Get();
+	const uint32 Checksum = ReplayCharacter ? CalculateChecksum(ReplayCharacter) : 0;
+	Report += FString::Printf(TEXT("Checksum,%08X\n"), Checksum);
+	if (Aborted)
+		Report += FString::Printf(TEXT("Aborted,%u\n"), Frame);
+
+	FFileHelper::SaveStringToFile(Report, *ReportFilename);
+
+	UE_LOG(LogALInputReplay, Display, TEXT("Replay %s: %d frames, avg %.3f ms, checksum %08X, report %s"),
+		Aborted ? TEXT("aborted") : TEXT("finished"), FrameMilliseconds.Num(), FrameMilliseconds.Num() > 0 ? TotalMilliseconds / FrameMilliseconds.Num() : 0.0, Checksum, *ReportFilename);
+
+	if (ExitWhenFinished)
+		FPlatformMisc::RequestExitWithStatus(false, Aborted ? 1 : 0);
+}
+
+uint32 FALInputReplayer::CalculateChecksum(const AALCharacter* Character)
+{
+	const FALMovementRuleState State = Character->GetMovementRuleState();
+	const FVector Location = Character->GetActorLocation();
+	const FVector Velocity = Character->GetCharacterMovement()->Velocity;
+	const uint8 IsOnOil = State.IsOnOil ? 1 : 0;
+
+	uint32 Crc = FCrc::MemCrc32(&Location, sizeof(Location));
+	Crc = FCrc::MemCrc32(&Velocity, sizeof(Velocity), Crc);
+	Crc = FCrc::MemCrc32(&State.JumpCounter, sizeof(State.JumpCounter), Crc);
+	Crc = FCrc::MemCrc32(&State.DashCounter, sizeof(State.DashCounter), Crc);
+	Crc = FCrc::MemCrc32(&IsOnOil, sizeof(IsOnOil), Crc);
+	return Crc;
+}
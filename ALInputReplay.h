@@ -0,0 +1,120 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+
+class AALCharacter;
+class UWorld;
+
+// Every input AALCharacter binds. Stored as a byte in recordings, so only add new entries at the end.
+enum class EALInputAction : uint8
+{
+	Jump,
+	SprintPressed,
+	SprintReleased,
+	ZoomIn,
+	ZoomOut,
+	SneakPressed,
+	SneakReleased,
+	// Fires whichever ability slot holds the projectile ability. Bound to the old Projectile action on characters without an ability set.
+	FireProjectile,
+	AimPressed,
+	AimReleased,
+	FirePush,
+	// One per UALAbilitySet slot
+	AbilitySlot0,
+	AbilitySlotLast = AbilitySlot0 + 7,
+
+	Count
+};
+
+enum class EALInputAxis : uint8
+{
+	MoveForward,
+	MoveRight,
+	LookHorizontal,
+	LookVertical,
+	TurnRate,
+
+	Count
+};
+
+DECLARE_DELEGATE_OneParam(FALInputActionDelegate, EALInputAction);
+
+struct FALRecordedInput
+{
+	static const uint8 AxisFlag = 0x80;
+
+	// Frames since the recording started
+	uint32 Frame;
+	// Action or axis index, with AxisFlag set for axes
+	uint8 Code;
+	// Only used by axes
+	float Value;
+};
+
+// Records every input that goes through AALCharacter's input dispatch. Axes are only stored when their value changes.
+// Everything is kept in memory and written to a compact binary file when the recorder is destroyed.
+class FALInputRecorder
+{
+public:
+
+	explicit FALInputRecorder(const FString& InFilename);
+	~FALInputRecorder();
+
+	void RecordAction(EALInputAction Action);
+	void RecordAxis(EALInputAxis Axis, float Value);
+
+private:
+
+	uint32 GetCurrentFrame() const;
+
+	FString Filename;
+	uint64 StartFrame;
+	float AxisValues[static_cast<int32>(EALInputAxis::Count)];
+	TArray<FALRecordedInput> Inputs;
+};
+
+// Feeds a recording back through AALCharacter's input dispatch at the start of every frame, before any actor ticks, with the
+// engine running at a fixed step. When the recording runs out it writes the time of every frame to a CSV file and logs a
+// checksum of the character's final movement state, so a CI run can catch both slowdowns and behaviour changes.
+//
+// Command line: -ALReplayInput=<File> [-ALReplayStep=<Seconds>] [-ALReplayReport=<CsvFile>] [-ALReplayExit]
+class FALInputReplayer
+{
+public:
+
+	FALInputReplayer(AALCharacter* InCharacter, const FString& Filename);
+	~FALInputReplayer();
+
+	bool IsReplaying() const { return !Finished; }
+
+	// Ends the replay early, like when its character is destroyed or returned to a pool. The report is still written, and
+	// with -ALReplayExit the game exits with an error so a CI run neither hangs nor passes without checking anything.
+	void Abort(const TCHAR* Reason);
+
+	static uint32 CalculateChecksum(const AALCharacter* Character);
+
+private:
+
+	void HandleWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void Finish();
+	void Fail(const FString& Error);
+
+	TWeakObjectPtr<AALCharacter> Character;
+	TArray<FALRecordedInput> Inputs;
+	FString ReportFilename;
+
+	int32 NextInput = 0;
+	uint32 Frame = 0;
+	uint32 LastFrame = 0;
+	float AxisValues[static_cast<int32>(EALInputAxis::Count)];
+
+	TArray<float> FrameMilliseconds;
+	double LastFrameTime = 0.0;
+
+	FDelegateHandle PreActorTickHandle;
+	bool Finished = false;
+	bool Aborted = false;
+	bool ExitWhenFinished = false;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// A press that is kept around for a short time when it can't be used yet, like a jump pressed just before landing.
+struct FALBufferedInput
+{
+	// World time of the press, negative when nothing is buffered
+	float PressedTime = -1.f;
+
+	FORCEINLINE void Press(float Now) { PressedTime = Now; }
+	FORCEINLINE void Consume() { PressedTime = -1.f; }
+
+	FORCEINLINE bool IsPending(float Now, float BufferTime) const
+	{
+		return PressedTime >= 0.f && Now - PressedTime <= BufferTime;
+	}
+};
+
+// Movement axes collected over a frame and turned into a single world space input.
+// The yaw basis is only rebuilt when the control yaw has changed since the last frame.
+struct FALMoveInput
+{
+	float Forward = 0.f;
+	float Right = 0.f;
+
+	FORCEINLINE bool IsZero() const { return Forward == 0.f && Right == 0.f; }
+	FORCEINLINE void Reset() { Forward = 0.f; Right = 0.f; }
+
+	FORCEINLINE FVector ToWorld(float Yaw)
+	{
+		if (Yaw != BasisYaw)
+		{
+			float Sin, Cos;
+			FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(Yaw));
+
+			// Same as the X and Y axes of FRotationMatrix(FRotator(0, Yaw, 0))
+			ForwardAxis = FVector(Cos, Sin, 0.f);
+			RightAxis = FVector(-Sin, Cos, 0.f);
+			BasisYaw = Yaw;
+		}
+
+		return ForwardAxis * Forward + RightAxis * Right;
+	}
+
+private:
+
+	float BasisYaw = TNumericLimits<float>::Max();
+	FVector ForwardAxis = FVector::ForwardVector;
+	FVector RightAxis = FVector::RightVector;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ALStats.h"
+
+// Edges of the character movement state. Nothing is posted while a state simply stays the same.
+enum class EALMovementEvent : uint8
+{
+	SprintStart,
+	SprintStop,
+	SlideStart,
+	SlideStop,
+	Dash,
+	Jump,
+	DoubleJump,
+	Landing,
+
+	Count
+};
+
+// Native event bus for movement edges.
+// C++ listeners subscribe to a single event and are called straight away when it's posted, without going through reflection.
+// Posted events are also queued so the Blueprint delegates can be broadcast in one batch per frame with Flush.
+class FALMovementEventBus
+{
+public:
+
+	FSimpleMulticastDelegate& OnEvent(EALMovementEvent Event)
+	{
+		return NativeListeners[static_cast<int32>(Event)];
+	}
+
+	void Post(EALMovementEvent Event)
+	{
+		INC_DWORD_STAT(STAT_ALNativeMovementEvents);
+
+		NativeListeners[static_cast<int32>(Event)].Broadcast();
+		PendingEvents.Add(Event);
+	}
+
+	bool HasPendingEvents() const { return PendingEvents.Num() > 0; }
+	void DiscardPendingEvents() { PendingEvents.Reset(); }
+
+	// Hands every event posted since the last flush to Dispatch, in the order they were posted.
+	template<typename DispatchFunc>
+	void Flush(DispatchFunc&& Dispatch)
+	{
+		if (PendingEvents.Num() == 0)
+			return;
+
+		// Copied so a listener posting a new event during the flush doesn't invalidate the iteration. It ends up in the next batch.
+		TArray<EALMovementEvent, TInlineAllocator<8>> Events = MoveTemp(PendingEvents);
+		PendingEvents.Reset();
+
+		for (EALMovementEvent Event : Events)
+			Dispatch(Event);
+	}
+
+private:
+
+	FSimpleMulticastDelegate NativeListeners[static_cast<int32>(EALMovementEvent::Count)];
+	TArray<EALMovementEvent, TInlineAllocator<8>> PendingEvents;
+};
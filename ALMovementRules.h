@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The parts of the movement state that the rules below work on. Used to hand a crowd agent over to a full AALCharacter and back.
+struct FALMovementRuleState
+{
+	bool IsOnOil = false;
+	float OilTime = 0.f;
+	float JumpCounter = 0.f;
+	float DashCounter = 0.f;
+};
+
+// Movement rules shared by AALCharacter and the crowd agents in UALCrowdSubsystem.
+// They don't touch any actor or component, so the crowd processors can run them on worker threads.
+namespace ALMovementRules
+{
+	// Counts up the time since stepping off oil. Returns true on the frame the oil wears off.
+	FORCEINLINE bool TickOilTimer(bool& IsOnOil, float& OilTime, float OilTimer, float DeltaSeconds)
+	{
+		if (!IsOnOil)
+			return false;
+
+		OilTime += DeltaSeconds;
+		if (OilTime < OilTimer)
+			return false;
+
+		IsOnOil = false;
+		OilTime = 0.f;
+		return true;
+	}
+
+	// Walk speed while sprinting, gliding when on oil. Not sprinting keeps the current speed.
+	FORCEINLINE float SprintWalkSpeed(float CurrentSpeed, bool IsOnOil, bool IsSprinting, float SprintSpeed, float GlidSpeed)
+	{
+		if (!IsSprinting)
+			return CurrentSpeed;
+
+		return IsOnOil ? GlidSpeed : SprintSpeed;
+	}
+
+	FORCEINLINE bool CanDoubleJump(bool IsAirborne, float JumpCounter, float MaxJumpCounter)
+	{
+		return IsAirborne && JumpCounter < MaxJumpCounter;
+	}
+
+	FORCEINLINE bool CanDash(bool IsAirborne, bool IsOnOil, float DashCounter, float MaxDashCounter)
+	{
+		return IsAirborne && !IsOnOil && DashCounter < MaxDashCounter;
+	}
+
+	FORCEINLINE void ResetOnLanding(float& JumpCounter, float& DashCounter)
+	{
+		JumpCounter = 0.f;
+		DashCounter = 0.f;
+	}
+}
@@ -0,0 +1,219 @@
+#include "ALProjectilePool.h"
+#include "Engine/World.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "TimerManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogALProjectilePool, Log, All);
+
+void UALProjectilePoolSubsystem::Deinitialize()
+{
+	LogStats();
+
+	Pools.Reset();
+	ActiveActors.Reset();
+
+	Super::Deinitialize();
+}
+
+FALActorPool& UALProjectilePoolSubsystem::FindOrAddPool(UClass* ActorClass)
+{
+	if (FALActorPool* Pool = Pools.Find(ActorClass))
+		return *Pool;
+
+	FALActorPool& Pool = Pools.Add(ActorClass);
+	Pool.LifeSpan = ActorClass->GetDefaultObject<AActor>()->InitialLifeSpan;
+	return Pool;
+}
+
+void UALProjectilePoolSubsystem::SetCapacity(TSubclassOf<AActor> ActorClass, int32 Capacity)
+{
+	if (ActorClass != nullptr)
+		FindOrAddPool(ActorClass).Capacity = FMath::Max(Capacity, 0);
+}
+
+void UALProjectilePoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (ActorClass == nullptr)
+		return;
+
+	FALActorPool& Pool = FindOrAddPool(ActorClass);
+	Pool.Capacity = FMath::Max(Pool.Capacity, Count);
+
+	const int32 NumToSpawn = FMath::Min(Count, Pool.Capacity) - Pool.FreeActors.Num() - Pool.NumInUse;
+	for (int32 i = 0; i < NumToSpawn; i++)
+	{
+		if (AActor* Actor = SpawnPooledActor(ActorClass))
+		{
+			DeactivateActor(Actor);
+			Pool.FreeActors.Add(Actor);
+		}
+	}
+}
+
+AActor* UALProjectilePoolSubsystem::SpawnPooledActor(UClass* ActorClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, FTransform::Identity, SpawnParams);
+	if (Actor == nullptr)
+		return nullptr;
+
+	// The pool decides when it goes away
+	Actor->SetLifeSpan(0.f);
+	Actor->OnDestroyed.AddDynamic(this, &UALProjectilePoolSubsystem::HandlePooledActorDestroyed);
+	return Actor;
+}
+
+AActor* UALProjectilePoolSubsystem::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+	if (ActorClass == nullptr)
+		return nullptr;
+
+	FALActorPool& Pool = FindOrAddPool(ActorClass);
+
+	AActor* Actor = nullptr;
+	while (Actor == nullptr && Pool.FreeActors.Num() > 0)
+		Actor = Pool.FreeActors.Pop(false);
+
+	if (Actor == nullptr)
+	{
+		Pool.Misses++;
+		Actor = SpawnPooledActor(ActorClass);
+		if (Actor == nullptr)
+			return nullptr;
+	}
+
+	Actor->SetOwner(Owner);
+	Actor->SetInstigator(Instigator);
+	ActivateActor(Actor, Transform);
+
+	Pool.NumInUse++;
+	Pool.PeakInUse = FMath::Max(Pool.PeakInUse, Pool.NumInUse);
+
+	FTimerHandle LifeSpanHandle;
+	if (Pool.LifeSpan > 0.f)
+		GetWorld()->GetTimerManager().SetTimer(LifeSpanHandle, FTimerDelegate::CreateUObject(this, &UALProjectilePoolSubsystem::HandleLifeSpanExpired, TWeakObjectPtr<AActor>(Actor)), Pool.LifeSpan, false);
+
+	ActiveActors.Add(Actor, LifeSpanHandle);
+	return Actor;
+}
+
+void UALProjectilePoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	FTimerHandle LifeSpanHandle;
+	if (Actor == nullptr || !ActiveActors.RemoveAndCopyValue(Actor, LifeSpanHandle))
+		return;
+
+	GetWorld()->GetTimerManager().ClearTimer(LifeSpanHandle);
+
+	FALActorPool& Pool = FindOrAddPool(Actor->GetClass());
+	Pool.NumInUse--;
+
+	if (Pool.FreeActors.Num() + Pool.NumInUse >= Pool.Capacity)
+	{
+		Actor->OnDestroyed.RemoveDynamic(this, &UALProjectilePoolSubsystem::HandlePooledActorDestroyed);
+		Actor->Destroy();
+		return;
+	}
+
+	DeactivateActor(Actor);
+	Pool.FreeActors.Add(Actor);
+}
+
+void UALProjectilePoolSubsystem::ReleaseOrDestroy(AActor* Actor)
+{
+	if (Actor == nullptr)
+		return;
+
+	UWorld* World = Actor->GetWorld();
+	UALProjectilePoolSubsystem* PoolSubsystem = World ? World->GetSubsystem<UALProjectilePoolSubsystem>() : nullptr;
+
+	if (PoolSubsystem && PoolSubsystem->ActiveActors.Contains(Actor))
+		PoolSubsystem->ReleaseActor(Actor);
+	else
+		Actor->Destroy();
+}
+
+void UALProjectilePoolSubsystem::HandleLifeSpanExpired(TWeakObjectPtr<AActor> Actor)
+{
+	ReleaseActor(Actor.Get());
+}
+
+void UALProjectilePoolSubsystem::HandlePooledActorDestroyed(AActor* Actor)
+{
+	// Something destroyed a pooled actor directly, so it just stops being counted
+	FALActorPool* Pool = Pools.Find(Actor->GetClass());
+	if (Pool == nullptr)
+		return;
+
+	FTimerHandle LifeSpanHandle;
+	if (ActiveActors.RemoveAndCopyValue(Actor, LifeSpanHandle))
+	{
+		GetWorld()->GetTimerManager().ClearTimer(LifeSpanHandle);
+		Pool->NumInUse--;
+	}
+	else
+		Pool->FreeActors.RemoveSwap(Actor);
+}
+
+void UALProjectilePoolSubsystem::DeactivateActor(AActor* Actor)
+{
+	if (UProjectileMovementComponent* ProjectileMovement = Actor->FindComponentByClass<UProjectileMovementComponent>())
+	{
+		ProjectileMovement->StopMovementImmediately();
+		ProjectileMovement->Deactivate();
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	if (IALPoolableActor* Poolable = Cast<IALPoolableActor>(Actor))
+		Poolable->OnReturnedToPool();
+}
+
+void UALProjectilePoolSubsystem::ActivateActor(AActor* Actor, const FTransform& Transform)
+{
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(true);
+
+	if (UProjectileMovementComponent* ProjectileMovement = Actor->FindComponentByClass<UProjectileMovementComponent>())
+	{
+		if (ProjectileMovement->UpdatedComponent == nullptr)
+			ProjectileMovement->SetUpdatedComponent(Actor->GetRootComponent());
+
+		ProjectileMovement->Velocity = Transform.GetRotation().GetForwardVector() * ProjectileMovement->InitialSpeed;
+		ProjectileMovement->Activate(true);
+		ProjectileMovement->UpdateComponentVelocity();
+	}
+
+	if (IALPoolableActor* Poolable = Cast<IALPoolableActor>(Actor))
+		Poolable->OnAcquiredFromPool();
+}
+
+FALActorPoolStats UALProjectilePoolSubsystem::GetStats(TSubclassOf<AActor> ActorClass) const
+{
+	FALActorPoolStats Stats;
+	if (const FALActorPool* Pool = Pools.Find(ActorClass))
+	{
+		Stats.NumFree = Pool->FreeActors.Num();
+		Stats.NumInUse = Pool->NumInUse;
+		Stats.PeakInUse = Pool->PeakInUse;
+		Stats.Misses = Pool->Misses;
+		Stats.Capacity = Pool->Capacity;
+	}
+	return Stats;
+}
+
+void UALProjectilePoolSubsystem::LogStats() const
+{
+	for (const TPair<UClass*, FALActorPool>& Pair : Pools)
+	{
+		const FALActorPool& Pool = Pair.Value;
+		UE_LOG(LogALProjectilePool, Log, TEXT("%s: peak %d in use of %d capacity, %d misses, %d free"),
+			*GetNameSafe(Pair.Key), Pool.PeakInUse, Pool.Capacity, Pool.Misses, Pool.FreeActors.Num());
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "ALProjectilePool.generated.h"
+
+UINTERFACE(MinimalAPI)
+class UALPoolableActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+// Optional for pooled actors that have their own state to reset on top of what the pool already does
+class IALPoolableActor
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnAcquiredFromPool() {}
+	virtual void OnReturnedToPool() {}
+};
+
+USTRUCT()
+struct FALActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AActor*> FreeActors;
+
+	// Actors beyond this are destroyed when released instead of kept
+	int32 Capacity = 32;
+	int32 NumInUse = 0;
+	int32 PeakInUse = 0;
+	// Acquires that found the pool empty and had to spawn
+	int32 Misses = 0;
+	// Taken from the class default object, since pooled actors have their life span cleared
+	float LifeSpan = 0.f;
+};
+
+struct FALActorPoolStats
+{
+	int32 NumFree = 0;
+	int32 NumInUse = 0;
+	int32 PeakInUse = 0;
+	int32 Misses = 0;
+	int32 Capacity = 0;
+};
+
+// Keeps fired projectiles around instead of destroying them, so throwing doesn't spawn an actor and GC doesn't have to clean it up.
+// Released actors are hidden, stop ticking and colliding, and have their projectile movement stopped. Acquiring one puts it back at the
+// new transform with the projectile movement's initial speed. Actors with an initial life span are released when it runs out.
+// Projectile code should call ReleaseOrDestroy where it would have called Destroy.
+UCLASS()
+class UALProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	UFUNCTION(BlueprintCallable, Category = "Projectile Pool")
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+
+	UFUNCTION(BlueprintCallable, Category = "Projectile Pool")
+	void ReleaseActor(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable, Category = "Projectile Pool")
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	UFUNCTION(BlueprintCallable, Category = "Projectile Pool")
+	void SetCapacity(TSubclassOf<AActor> ActorClass, int32 Capacity);
+
+	FALActorPoolStats GetStats(TSubclassOf<AActor> ActorClass) const;
+	void LogStats() const;
+
+	// Releases pooled actors and destroys everything else
+	UFUNCTION(BlueprintCallable, Category = "Projectile Pool", meta = (DefaultToSelf = "Actor"))
+	static void ReleaseOrDestroy(AActor* Actor);
+
+private:
+
+	FALActorPool& FindOrAddPool(UClass* ActorClass);
+	AActor* SpawnPooledActor(UClass* ActorClass);
+
+	static void DeactivateActor(AActor* Actor);
+	static void ActivateActor(AActor* Actor, const FTransform& Transform);
+
+	UFUNCTION()
+	void HandlePooledActorDestroyed(AActor* Actor);
+
+	void HandleLifeSpanExpired(TWeakObjectPtr<AActor> Actor);
+
+	UPROPERTY()
+	TMap<UClass*, FALActorPool> Pools;
+
+	// Actors currently handed out, and the timer releasing them if their class has a life span
+	TMap<TWeakObjectPtr<AActor>, FTimerHandle> ActiveActors;
+};
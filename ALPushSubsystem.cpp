@@ -0,0 +1,148 @@
+#include "ALPushSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "ALStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Push Overlap Results"), STAT_ALPushOverlapResults, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("Push Apply Impulses"), STAT_ALPushApplyImpulses, STATGROUP_ALCharacter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Push Impulses Applied"), STAT_ALPushImpulsesApplied, STATGROUP_ALCharacter);
+
+void UALPushSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	OverlapDelegate.BindUObject(this, &UALPushSubsystem::HandleOverlapCompleted);
+}
+
+void UALPushSubsystem::Deinitialize()
+{
+	OverlapDelegate.Unbind();
+	PendingPushes.Reset();
+	QueuedImpulses.Reset();
+	NextImpulse = 0;
+
+	Super::Deinitialize();
+}
+
+bool UALPushSubsystem::IsTickable() const
+{
+	return !IsTemplate() && (GetNumPendingImpulses() > 0 || OverlapMilliseconds > 0.0);
+}
+
+TStatId UALPushSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UALPushSubsystem, STATGROUP_Tickables);
+}
+
+void UALPushSubsystem::QueuePush(AActor* Instigator, const FVector& Origin, float Radius, float Strength)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || Radius <= 0.f)
+		return;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ALPush), false, Instigator);
+	const FTraceHandle TraceHandle = World->AsyncOverlapByChannel(Origin, FQuat::Identity, PushChannel, FCollisionShape::MakeSphere(Radius), QueryParams,
+		FCollisionResponseParams::DefaultResponseParam, &OverlapDelegate);
+
+	PendingPushes.Add(TraceHandle, { Origin, Strength });
+}
+
+void UALPushSubsystem::HandleOverlapCompleted(const FTraceHandle& TraceHandle, FOverlapDatum& OverlapDatum)
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALPushOverlapResults);
+
+	FALPendingPush Push;
+	if (!PendingPushes.RemoveAndCopyValue(TraceHandle, Push))
+		return;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	QueuedImpulses.Reserve(QueuedImpulses.Num() + OverlapDatum.OutOverlaps.Num());
+	for (const FOverlapResult& Overlap : OverlapDatum.OutOverlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component == nullptr || !Component->IsSimulatingPhysics())
+			continue;
+
+		FBodyInstance* BodyInstance = Component->GetBodyInstance(NAME_None, true, Overlap.ItemIndex);
+		if (BodyInstance == nullptr)
+			continue;
+
+		FVector Direction = BodyInstance->GetUnrealWorldTransform().GetLocation() - Push.Origin;
+		Direction = Direction.IsNearlyZero() ? FVector::UpVector : Direction.GetUnsafeNormal();
+
+		QueuedImpulses.Add({ Component, Overlap.ItemIndex, Direction * Push.Strength });
+	}
+
+	OverlapMilliseconds += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+}
+
+void UALPushSubsystem::Tick(float DeltaTime)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	ApplyQueuedImpulses();
+
+	LastFrameMilliseconds = OverlapMilliseconds + (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	LastProcessedFrame = GFrameCounter;
+	OverlapMilliseconds = 0.0;
+}
+
+void UALPushSubsystem::ApplyQueuedImpulses()
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALPushApplyImpulses);
+
+	const int32 EndImpulse = FMath::Min(NextImpulse + MaxImpulsesPerFrame, QueuedImpulses.Num());
+
+	struct FBodyImpulse
+	{
+		FPhysScene* Scene;
+		FBodyInstance* BodyInstance;
+		FVector Impulse;
+	};
+
+	TArray<FBodyImpulse, TInlineAllocator<128>> Batch;
+	for (int32 i = NextImpulse; i < EndImpulse; i++)
+	{
+		const FALQueuedImpulse& Queued = QueuedImpulses[i];
+
+		UPrimitiveComponent* Component = Queued.Component.Get();
+		FBodyInstance* BodyInstance = Component ? Component->GetBodyInstance(NAME_None, true, Queued.BodyIndex) : nullptr;
+		if (BodyInstance && BodyInstance->IsInstanceSimulatingPhysics())
+			Batch.Add({ BodyInstance->GetPhysicsScene(), BodyInstance, Queued.Impulse });
+	}
+
+	NextImpulse = EndImpulse;
+	if (NextImpulse == QueuedImpulses.Num())
+	{
+		QueuedImpulses.Reset();
+		NextImpulse = 0;
+	}
+
+	// One write lock per scene for the whole batch
+	Batch.Sort([](const FBodyImpulse& A, const FBodyImpulse& B) { return A.Scene < B.Scene; });
+
+	for (int32 First = 0; First < Batch.Num();)
+	{
+		int32 Last = First;
+		while (Last < Batch.Num() && Batch[Last].Scene == Batch[First].Scene)
+			Last++;
+
+		FPhysicsCommand::ExecuteWrite(Batch[First].Scene, [&Batch, First, Last]()
+		{
+			for (int32 i = First; i < Last; i++)
+			{
+				const FPhysicsActorHandle& ActorHandle = Batch[i].BodyInstance->GetPhysicsActorHandle();
+				FPhysicsInterface::AddImpulse_AssumesLocked(ActorHandle, Batch[i].Impulse);
+				FPhysicsInterface::WakeUp_AssumesLocked(ActorHandle);
+			}
+		});
+
+		First = Last;
+	}
+
+	INC_DWORD_STAT_BY(STAT_ALPushImpulsesApplied, Batch.Num());
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "ALPushSubsystem.generated.h"
+
+struct FALQueuedImpulse
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	int32 BodyIndex;
+	FVector Impulse;
+};
+
+// Pushes physics bodies away from a point without blocking the frame the push was requested in. The overlap runs as an async
+// query and its results arrive next frame. Impulses are queued and applied at most MaxImpulsesPerFrame per frame, with one
+// physics scene write lock per scene instead of one per body, so pushing into a large pile is spread over several frames.
+UCLASS()
+class UALPushSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// Ignores Instigator's own bodies. Strength is the impulse each body gets, independent of distance.
+	void QueuePush(AActor* Instigator, const FVector& Origin, float Radius, float Strength);
+
+	int32 GetNumPendingPushes() const { return PendingPushes.Num(); }
+	int32 GetNumPendingImpulses() const { return QueuedImpulses.Num() - NextImpulse; }
+	// Game-thread time spent on pushes during the last tick, including the overlap results delivered that frame
+	double GetLastFrameMilliseconds() const { return LastFrameMilliseconds; }
+	uint64 GetLastProcessedFrame() const { return LastProcessedFrame; }
+
+	UPROPERTY(EditAnywhere, Category = "Push", meta = (ClampMin = "1"))
+	int32 MaxImpulsesPerFrame = 128;
+
+	UPROPERTY(EditAnywhere, Category = "Push")
+	TEnumAsByte<ECollisionChannel> PushChannel = ECC_PhysicsBody;
+
+private:
+
+	struct FALPendingPush
+	{
+		FVector Origin;
+		float Strength;
+	};
+
+	void HandleOverlapCompleted(const FTraceHandle& TraceHandle, FOverlapDatum& OverlapDatum);
+	void ApplyQueuedImpulses();
+
+	FOverlapDelegate OverlapDelegate;
+	TMap<FTraceHandle, FALPendingPush> PendingPushes;
+
+	// Consumed from NextImpulse onwards and compacted once drained, so spreading a push over frames doesn't shift the array each frame
+	TArray<FALQueuedImpulse> QueuedImpulses;
+	int32 NextImpulse = 0;
+
+	double OverlapMilliseconds = 0.0;
+	double LastFrameMilliseconds = 0.0;
+	uint64 LastProcessedFrame = 0;
+};
@@ -0,0 +1,147 @@
+#include "ALSignificanceSubsystem.h"
+#include "AALCharacter.h"
+#include "ALStats.h"
+#include "SignificanceManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance: Critical"), STAT_ALSignificanceCritical, STATGROUP_ALCharacter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance: High"), STAT_ALSignificanceHigh, STATGROUP_ALCharacter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance: Medium"), STAT_ALSignificanceMedium, STATGROUP_ALCharacter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance: Low"), STAT_ALSignificanceLow, STATGROUP_ALCharacter);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Significance: Tick ms saved (estimate)"), STAT_ALSignificanceTimeSaved, STATGROUP_ALCharacter);
+
+static const FName SignificanceTag(TEXT("ALCharacter"));
+
+// Only the character being looked through needs the camera probe, and only nearby characters are worth the cosmetic events
+static const FALSignificanceSettings SignificanceSettings[] =
+{
+	/* Low */		{ 0.2f,			1.f / 10.f,	false,	false },
+	/* Medium */	{ 1.f / 20.f,	1.f / 30.f,	false,	true },
+	/* High */		{ 0.f,			0.f,		false,	true },
+	/* Critical */	{ 0.f,			0.f,		true,	true },
+};
+
+const FALSignificanceSettings& UALSignificanceSubsystem::GetSettings(EALSignificance Significance)
+{
+	return SignificanceSettings[static_cast<int32>(Significance)];
+}
+
+bool UALSignificanceSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Characters.Num() > 0;
+}
+
+TStatId UALSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UALSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UALSignificanceSubsystem::RegisterCharacter(AALCharacter* Character)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (SignificanceManager == nullptr)
+		return;
+
+	Characters.AddUnique(Character);
+
+	SignificanceManager->RegisterObject(Character, SignificanceTag,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+		{
+			return CalculateSignificance(CastChecked<AALCharacter>(ObjectInfo->GetObject()), Viewpoint);
+		},
+		USignificanceManager::EPostSignificanceType::Sequential,
+		[](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+		{
+			CastChecked<AALCharacter>(ObjectInfo->GetObject())->SetSignificance(static_cast<EALSignificance>(FMath::RoundToInt(Significance)));
+		});
+}
+
+void UALSignificanceSubsystem::UnregisterCharacter(AALCharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+
+	if (USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld()))
+		SignificanceManager->UnregisterObject(Character);
+}
+
+void UALSignificanceSubsystem::ReportTickCost(double Seconds)
+{
+	AverageTickCost = AverageTickCost == 0.0 ? Seconds : FMath::Lerp(AverageTickCost, Seconds, 0.05);
+}
+
+float UALSignificanceSubsystem::CalculateSignificance(const AALCharacter* Character, const FTransform& Viewpoint) const
+{
+	if (Character->IsLocallyControlled())
+		return static_cast<float>(EALSignificance::Critical);
+
+	const float DistanceSquared = FVector::DistSquared(Character->GetActorLocation(), Viewpoint.GetLocation());
+
+	int32 Bucket = static_cast<int32>(EALSignificance::Low);
+	if (DistanceSquared < FMath::Square(HighDistance))
+		Bucket = static_cast<int32>(EALSignificance::High);
+	else if (DistanceSquared < FMath::Square(MediumDistance))
+		Bucket = static_cast<int32>(EALSignificance::Medium);
+
+	if (!Character->WasRecentlyRendered(VisibilityTimeout))
+		Bucket = FMath::Max(Bucket - 1, static_cast<int32>(EALSignificance::Low));
+
+	return static_cast<float>(Bucket);
+}
+
+void UALSignificanceSubsystem::Tick(float DeltaTime)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (SignificanceManager == nullptr)
+		return;
+
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController())
+			continue;
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		Viewpoints.Emplace(ViewRotation, ViewLocation);
+	}
+
+	// A dedicated server has nobody looking, so there's nothing to rank the characters by and none of them is throttled
+	if (Viewpoints.Num() == 0)
+	{
+		for (AALCharacter* Character : Characters)
+		{
+			if (Character)
+				Character->SetSignificance(EALSignificance::High);
+		}
+	}
+	else
+		SignificanceManager->Update(Viewpoints);
+
+#if STATS
+	uint32 BucketCounts[4] = { 0, 0, 0, 0 };
+	double SavedSeconds = 0.0;
+
+	for (const AALCharacter* Character : Characters)
+	{
+		if (Character == nullptr)
+			continue;
+
+		const EALSignificance Significance = Character->GetSignificance();
+		BucketCounts[static_cast<int32>(Significance)]++;
+
+		// The part of a frame's tick a throttled character doesn't run, on average
+		const float TickInterval = Character->GetActorTickInterval();
+		if (TickInterval > DeltaTime)
+			SavedSeconds += AverageTickCost * (1.0 - DeltaTime / TickInterval);
+	}
+
+	SET_DWORD_STAT(STAT_ALSignificanceLow, BucketCounts[static_cast<int32>(EALSignificance::Low)]);
+	SET_DWORD_STAT(STAT_ALSignificanceMedium, BucketCounts[static_cast<int32>(EALSignificance::Medium)]);
+	SET_DWORD_STAT(STAT_ALSignificanceHigh, BucketCounts[static_cast<int32>(EALSignificance::High)]);
+	SET_DWORD_STAT(STAT_ALSignificanceCritical, BucketCounts[static_cast<int32>(EALSignificance::Critical)]);
+	SET_FLOAT_STAT(STAT_ALSignificanceTimeSaved, SavedSeconds * 1000.0);
+#endif
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ALSignificanceSubsystem.generated.h"
+
+class AALCharacter;
+
+// Higher is more significant. Also used as the significance value handed to the significance manager.
+UENUM(BlueprintType)
+enum class EALSignificance : uint8
+{
+	Low,
+	Medium,
+	High,
+	Critical
+};
+
+// How much work a character does in each significance bucket
+struct FALSignificanceSettings
+{
+	float ActorTickInterval;
+	float MovementTickInterval;
+	bool CameraProbing;
+	bool CosmeticEvents;
+};
+
+// Feeds the local players' view points to the significance manager every frame and sorts every AALCharacter into a bucket by
+// distance and visibility. Characters far away or off-screen tick less often and skip the cosmetic work.
+// The authority only ever skips the cosmetic work, the movement it runs for its characters is what everyone else gets corrected to.
+// Without any local player, as on a dedicated server, every character is High.
+UCLASS()
+class UALSignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterCharacter(AALCharacter* Character);
+	void UnregisterCharacter(AALCharacter* Character);
+
+	// Characters report how long a full tick took, which is what the time saved by throttling is estimated from
+	void ReportTickCost(double Seconds);
+
+	static const FALSignificanceSettings& GetSettings(EALSignificance Significance);
+
+	UPROPERTY(BlueprintReadWrite, Category = "Significance")
+	float HighDistance = 2000.f;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Significance")
+	float MediumDistance = 5000.f;
+
+	// Characters that haven't been rendered for this long drop one bucket
+	UPROPERTY(BlueprintReadWrite, Category = "Significance")
+	float VisibilityTimeout = 0.5f;
+
+private:
+
+	float CalculateSignificance(const AALCharacter* Character, const FTransform& Viewpoint) const;
+
+	UPROPERTY()
+	TArray<AALCharacter*> Characters;
+
+	TArray<FTransform> Viewpoints;
+
+	// Moving average of a full character tick
+	double AverageTickCost = 0.0;
+};
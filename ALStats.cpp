@@ -0,0 +1,10 @@
+#include "ALStats.h"
+
+DEFINE_STAT(STAT_ALBlueprintBroadcasts);
+DEFINE_STAT(STAT_ALNativeMovementEvents);
+DEFINE_STAT(STAT_ALLaunchCharacterCalls);
+DEFINE_STAT(STAT_ALCosmeticStateDirty);
+
+UE_TRACE_CHANNEL_DEFINE(ALCharacterChannel);
+
+DEFINE_LOG_CATEGORY(LogALCharacter);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Everything the character and its systems report shows up under "stat ALCharacter"
+DECLARE_STATS_GROUP(TEXT("AL Character"), STATGROUP_ALCharacter, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Blueprint delegate broadcasts"), STAT_ALBlueprintBroadcasts, STATGROUP_ALCharacter, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Native movement events"), STAT_ALNativeMovementEvents, STATGROUP_ALCharacter, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("LaunchCharacter calls"), STAT_ALLaunchCharacterCalls, STATGROUP_ALCharacter, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cosmetic state dirty marks"), STAT_ALCosmeticStateDirty, STATGROUP_ALCharacter, );
+
+// Turn on with -trace=cpu,ALCharacter to see the character scopes in Unreal Insights
+UE_TRACE_CHANNEL_EXTERN(ALCharacterChannel);
+
+// Times a scope for "stat ALCharacter" and marks it on the ALCharacter trace channel. Both compile out when stats and tracing are off.
+#define AL_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Stat, ALCharacterChannel)
+
+// The character's own log. Verbose messages, like the one on every double jump, are compiled out of Test and Shipping builds.
+#if UE_BUILD_SHIPPING || UE_BUILD_TEST
+#define AL_CHARACTER_LOG_COMPILE_VERBOSITY Warning
+#else
+#define AL_CHARACTER_LOG_COMPILE_VERBOSITY All
+#endif
+
+DECLARE_LOG_CATEGORY_EXTERN(LogALCharacter, Log, AL_CHARACTER_LOG_COMPILE_VERBOSITY);
@@ -0,0 +1,261 @@
+#include "ALStatusEffectSubsystem.h"
+#include "AALCharacter.h"
+#include "ALStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Status Effects Tick"), STAT_ALStatusEffectsTick, STATGROUP_ALCharacter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Status Effects Active"), STAT_ALStatusEffectsActive, STATGROUP_ALCharacter);
+
+// Width of one wheel slot. Effects run out at most this late.
+static const float SlotSeconds = 1.f / 30.f;
+
+void UALStatusEffectSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	for (int32& Head : SlotHeads)
+		Head = INDEX_NONE;
+}
+
+void UALStatusEffectSubsystem::Deinitialize()
+{
+	Effects.Reset();
+	FreeEffects.Reset();
+	Targets.Reset();
+	FreeTargets.Reset();
+	TargetIndices.Reset();
+	DirtyTargets.Reset();
+	NumTimedEffects = 0;
+
+	Super::Deinitialize();
+}
+
+bool UALStatusEffectSubsystem::IsTickable() const
+{
+	return !IsTemplate() && (NumTimedEffects > 0 || DirtyTargets.Num() > 0);
+}
+
+TStatId UALStatusEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UALStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+int32 UALStatusEffectSubsystem::FindOrAddTarget(AALCharacter* Character)
+{
+	if (const int32* Index = TargetIndices.Find(Character))
+		return *Index;
+
+	const int32 Index = FreeTargets.Num() > 0 ? FreeTargets.Pop(false) : Targets.AddDefaulted();
+	Targets[Index] = FTarget();
+	Targets[Index].Character = Character;
+	Targets[Index].IsInUse = true;
+	TargetIndices.Add(Character, Index);
+	return Index;
+}
+
+void UALStatusEffectSubsystem::ReleaseTarget(int32 TargetIndex)
+{
+	FTarget& Target = Targets[TargetIndex];
+	if (!Target.IsInUse)
+		return;
+
+	// Keeps the releases below from queueing the target again
+	Target.IsDirty = true;
+	while (Target.FirstEffect != INDEX_NONE)
+		ReleaseEffect(Target.FirstEffect);
+
+	TargetIndices.Remove(Target.Character);
+	Target = FTarget();
+	FreeTargets.Add(TargetIndex);
+}
+
+void UALStatusEffectSubsystem::MarkDirty(int32 TargetIndex)
+{
+	FTarget& Target = Targets[TargetIndex];
+	if (Target.IsDirty)
+		return;
+
+	Target.IsDirty = true;
+	DirtyTargets.Add(TargetIndex);
+}
+
+FALStatusEffectHandle UALStatusEffectSubsystem::ApplyEffect(AALCharacter* Character, const FALStatusEffectSpec& Spec)
+{
+	FALStatusEffectHandle Handle;
+	if (Character == nullptr)
+		return Handle;
+
+	const int32 TargetIndex = FindOrAddTarget(Character);
+	const int32 EffectIndex = FreeEffects.Num() > 0 ? FreeEffects.Pop(false) : Effects.AddDefaulted();
+
+	FEffect& Effect = Effects[EffectIndex];
+	Effect = FEffect();
+	Effect.Spec = Spec;
+	Effect.Target = TargetIndex;
+	Effect.Serial = NextSerial++;
+
+	// Front of the target's list
+	FTarget& Target = Targets[TargetIndex];
+	Effect.TargetNext = Target.FirstEffect;
+	if (Target.FirstEffect != INDEX_NONE)
+		Effects[Target.FirstEffect].TargetPrev = EffectIndex;
+	Target.FirstEffect = EffectIndex;
+
+	if (Spec.Duration > 0.f)
+	{
+		// Counted from the start of the current slot, so the time already spent in it is added back
+		const int32 Ticks = FMath::Max(FMath::CeilToInt((Spec.Duration + SlotTime) / SlotSeconds), 1);
+		Effect.Slot = (Cursor + Ticks) & SlotMask;
+		Effect.Rounds = (Ticks - 1) / NumSlots;
+
+		Effect.SlotNext = SlotHeads[Effect.Slot];
+		if (SlotHeads[Effect.Slot] != INDEX_NONE)
+			Effects[SlotHeads[Effect.Slot]].SlotPrev = EffectIndex;
+		SlotHeads[Effect.Slot] = EffectIndex;
+		NumTimedEffects++;
+	}
+
+	MarkDirty(TargetIndex);
+	INC_DWORD_STAT(STAT_ALStatusEffectsActive);
+
+	Handle.Index = EffectIndex;
+	Handle.Serial = Effect.Serial;
+	return Handle;
+}
+
+bool UALStatusEffectSubsystem::IsEffectActive(const FALStatusEffectHandle& Handle) const
+{
+	return Effects.IsValidIndex(Handle.Index) && Effects[Handle.Index].Serial == Handle.Serial && Handle.Serial != 0;
+}
+
+float UALStatusEffectSubsystem::GetRemainingTime(const FALStatusEffectHandle& Handle) const
+{
+	if (!IsEffectActive(Handle))
+		return 0.f;
+
+	const FEffect& Effect = Effects[Handle.Index];
+	if (Effect.Slot == INDEX_NONE)
+		return 0.f;
+
+	const int32 Ticks = ((Effect.Slot - Cursor) & SlotMask) + Effect.Rounds * NumSlots;
+	return FMath::Max(Ticks * SlotSeconds - SlotTime, 0.f);
+}
+
+void UALStatusEffectSubsystem::RemoveEffect(FALStatusEffectHandle& Handle)
+{
+	if (IsEffectActive(Handle))
+		ReleaseEffect(Handle.Index);
+
+	Handle.Reset();
+}
+
+void UALStatusEffectSubsystem::RemoveAllEffects(AALCharacter* Character)
+{
+	const int32* TargetIndex = TargetIndices.Find(Character);
+	if (TargetIndex == nullptr)
+		return;
+
+	while (Targets[*TargetIndex].FirstEffect != INDEX_NONE)
+		ReleaseEffect(Targets[*TargetIndex].FirstEffect);
+}
+
+void UALStatusEffectSubsystem::ReleaseEffect(int32 EffectIndex)
+{
+	FEffect& Effect = Effects[EffectIndex];
+
+	if (Effect.Slot != INDEX_NONE)
+	{
+		if (Effect.SlotPrev != INDEX_NONE)
+			Effects[Effect.SlotPrev].SlotNext = Effect.SlotNext;
+		else
+			SlotHeads[Effect.Slot] = Effect.SlotNext;
+
+		if (Effect.SlotNext != INDEX_NONE)
+			Effects[Effect.SlotNext].SlotPrev = Effect.SlotPrev;
+
+		NumTimedEffects--;
+	}
+
+	FTarget& Target = Targets[Effect.Target];
+	if (Effect.TargetPrev != INDEX_NONE)
+		Effects[Effect.TargetPrev].TargetNext = Effect.TargetNext;
+	else
+		Target.FirstEffect = Effect.TargetNext;
+
+	if (Effect.TargetNext != INDEX_NONE)
+		Effects[Effect.TargetNext].TargetPrev = Effect.TargetPrev;
+
+	MarkDirty(Effect.Target);
+
+	// A zero serial never matches a handle, so handles to released effects stop working
+	Effect.Serial = 0;
+	Effect.Slot = INDEX_NONE;
+	FreeEffects.Add(EffectIndex);
+	DEC_DWORD_STAT(STAT_ALStatusEffectsActive);
+}
+
+void UALStatusEffectSubsystem::ExpireSlot(int32 Slot)
+{
+	int32 EffectIndex = SlotHeads[Slot];
+	while (EffectIndex != INDEX_NONE)
+	{
+		FEffect& Effect = Effects[EffectIndex];
+		const int32 Next = Effect.SlotNext;
+
+		if (Effect.Rounds > 0)
+			Effect.Rounds--;
+		else
+			ReleaseEffect(EffectIndex);
+
+		EffectIndex = Next;
+	}
+}
+
+void UALStatusEffectSubsystem::Tick(float DeltaTime)
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALStatusEffectsTick);
+
+	SlotTime += DeltaTime;
+	int32 SlotsToVisit = FMath::FloorToInt(SlotTime / SlotSeconds);
+	SlotTime -= SlotsToVisit * SlotSeconds;
+
+	while (SlotsToVisit-- > 0)
+	{
+		Cursor = (Cursor + 1) & SlotMask;
+		ExpireSlot(Cursor);
+	}
+
+	ApplyDirtyTargets();
+}
+
+void UALStatusEffectSubsystem::ApplyDirtyTargets()
+{
+	// Anything the characters change in response is picked up next frame
+	TArray<int32> PendingTargets = MoveTemp(DirtyTargets);
+	DirtyTargets.Reset();
+
+	for (int32 TargetIndex : PendingTargets)
+	{
+		FTarget& Target = Targets[TargetIndex];
+		if (!Target.IsInUse)
+			continue;
+
+		Target.IsDirty = false;
+
+		FALStatusEffectTotals Totals;
+		for (int32 EffectIndex = Target.FirstEffect; EffectIndex != INDEX_NONE; EffectIndex = Effects[EffectIndex].TargetNext)
+		{
+			const FALStatusEffectSpec& Spec = Effects[EffectIndex].Spec;
+			Totals.AdditiveSpeed += Spec.AdditiveSpeed;
+			Totals.SpeedMultiplier *= Spec.SpeedMultiplier;
+			Totals.ActiveTypes |= 1u << static_cast<uint32>(Spec.Type);
+		}
+
+		AALCharacter* Character = Target.Character.Get();
+		if (Character)
+			Character->ApplyStatusEffects(Totals);
+
+		// Nothing left to track for characters without effects, or ones that are gone. Looked up again since the character may have added effects.
+		if (Targets[TargetIndex].FirstEffect == INDEX_NONE || Character == nullptr)
+			ReleaseTarget(TargetIndex);
+	}
+}
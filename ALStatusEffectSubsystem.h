@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ALStatusEffectSubsystem.generated.h"
+
+class AALCharacter;
+
+enum class EALStatusEffect : uint8
+{
+	// Gameplay slow, caps the speed at the character's SlowSpeed
+	Slow,
+	// Only contributes its speed modifiers
+	Speed,
+
+	Count
+};
+
+struct FALStatusEffectSpec
+{
+	EALStatusEffect Type = EALStatusEffect::Speed;
+	// 0 or less lasts until removed
+	float Duration = 0.f;
+	float AdditiveSpeed = 0.f;
+	float SpeedMultiplier = 1.f;
+};
+
+struct FALStatusEffectHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Reset() { Index = INDEX_NONE; Serial = 0; }
+};
+
+// Everything active on one character, combined
+struct FALStatusEffectTotals
+{
+	float AdditiveSpeed = 0.f;
+	float SpeedMultiplier = 1.f;
+	// One bit per EALStatusEffect
+	uint32 ActiveTypes = 0;
+
+	bool Has(EALStatusEffect Type) const { return (ActiveTypes & (1u << static_cast<uint32>(Type))) != 0; }
+};
+
+// Timed effects for every character in the world. Expiry is a timer wheel: effects sit in the slot they run out in, and the
+// wheel only visits the slots time has passed, so nothing counts down per actor and expiring an effect is constant time.
+// Adding or removing an effect marks its character dirty. Dirty characters get their totals recombined once per frame and
+// handed to the character and its movement component. The subsystem only ticks while a timed effect is waiting on the wheel
+// or a character is dirty, so untimed effects cost nothing per frame.
+UCLASS()
+class UALStatusEffectSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	FALStatusEffectHandle ApplyEffect(AALCharacter* Character, const FALStatusEffectSpec& Spec);
+	void RemoveEffect(FALStatusEffectHandle& Handle);
+	void RemoveAllEffects(AALCharacter* Character);
+
+	bool IsEffectActive(const FALStatusEffectHandle& Handle) const;
+	// 0 for untimed and inactive effects
+	float GetRemainingTime(const FALStatusEffectHandle& Handle) const;
+
+	int32 GetNumActiveEffects() const { return Effects.Num() - FreeEffects.Num(); }
+
+private:
+
+	static const int32 NumSlots = 256;
+	static const int32 SlotMask = NumSlots - 1;
+
+	struct FEffect
+	{
+		FALStatusEffectSpec Spec;
+		int32 Target = INDEX_NONE;
+		uint32 Serial = 0;
+		// Wheel slot and how many more turns of the wheel it waits, INDEX_NONE for untimed effects
+		int32 Slot = INDEX_NONE;
+		int32 Rounds = 0;
+		// Links in the slot's list and in the target's list
+		int32 SlotPrev = INDEX_NONE;
+		int32 SlotNext = INDEX_NONE;
+		int32 TargetPrev = INDEX_NONE;
+		int32 TargetNext = INDEX_NONE;
+	};
+
+	struct FTarget
+	{
+		TWeakObjectPtr<AALCharacter> Character;
+		int32 FirstEffect = INDEX_NONE;
+		bool IsInUse = false;
+		bool IsDirty = false;
+	};
+
+	int32 FindOrAddTarget(AALCharacter* Character);
+	void MarkDirty(int32 TargetIndex);
+	void ReleaseTarget(int32 TargetIndex);
+	void ReleaseEffect(int32 EffectIndex);
+	void ExpireSlot(int32 Slot);
+	void ApplyDirtyTargets();
+
+	TArray<FEffect> Effects;
+	TArray<int32> FreeEffects;
+	int32 SlotHeads[NumSlots];
+	int32 Cursor = 0;
+	float SlotTime = 0.f;
+	uint32 NextSerial = 1;
+	int32 NumTimedEffects = 0;
+
+	TArray<FTarget> Targets;
+	TArray<int32> FreeTargets;
+	TMap<TWeakObjectPtr<AALCharacter>, int32> TargetIndices;
+	TArray<int32> DirtyTargets;
+};
@@ -0,0 +1,187 @@
+#include "ALTelemetry.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Compression.h"
+#include "Misc/DateTime.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogALTelemetry, Log, All);
+
+FALTelemetryRing::FALTelemetryRing(uint32 CapacityPowerOfTwo)
+{
+	check(FMath::IsPowerOfTwo(CapacityPowerOfTwo));
+
+	Records.SetNumUninitialized(CapacityPowerOfTwo);
+	Mask = CapacityPowerOfTwo - 1;
+}
+
+int32 FALTelemetryRing::Pop(TArray<FALTelemetryRecord>& OutRecords, int32 MaxRecords)
+{
+	const uint32 Read = ReadIndex.Load(EMemoryOrder::Relaxed);
+	const uint32 NumRecords = FMath::Min<uint32>(WriteIndex.Load() - Read, static_cast<uint32>(MaxRecords));
+
+	for (uint32 i = 0; i < NumRecords; i++)
+		OutRecords.Add(Records[(Read + i) & Mask]);
+
+	// Only now can the game thread write over them
+	ReadIndex.Store(Read + NumRecords);
+	return static_cast<int32>(NumRecords);
+}
+
+FALTelemetryWriter::FALTelemetryWriter(FALTelemetryRing& InRing, const FString& InFilename)
+	: Ring(InRing)
+	, Filename(InFilename)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+
+	File.Reset(PlatformFile.OpenWrite(*Filename));
+	if (!File.IsValid())
+	{
+		UE_LOG(LogALTelemetry, Error, TEXT("Couldn't open %s, telemetry isn't recorded"), *Filename);
+		return;
+	}
+
+	const uint32 FileMagic = Magic;
+	const uint16 FileVersion = Version;
+	const uint16 RecordSize = sizeof(FALTelemetryRecord);
+	File->Write(reinterpret_cast<const uint8*>(&FileMagic), sizeof(FileMagic));
+	File->Write(reinterpret_cast<const uint8*>(&FileVersion), sizeof(FileVersion));
+	File->Write(reinterpret_cast<const uint8*>(&RecordSize), sizeof(RecordSize));
+
+	ChunkRecords.Reserve(MaxRecordsPerChunk);
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("ALTelemetryWriter"), 0, TPri_BelowNormal);
+
+	UE_LOG(LogALTelemetry, Display, TEXT("Recording telemetry to %s"), *Filename);
+}
+
+FALTelemetryWriter::~FALTelemetryWriter()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	// The thread is gone, so the rest of the ring is flushed from here
+	if (File.IsValid())
+	{
+		while (FlushChunk())
+		{
+		}
+		File->Flush();
+		File.Reset();
+	}
+
+	if (WakeEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+}
+
+uint32 FALTelemetryWriter::Run()
+{
+	const uint32 FlushIntervalMilliseconds = 100;
+
+	while (!IsStopping)
+	{
+		while (FlushChunk())
+		{
+		}
+
+		WakeEvent->Wait(FlushIntervalMilliseconds);
+	}
+
+	return 0;
+}
+
+void FALTelemetryWriter::Stop()
+{
+	IsStopping = true;
+
+	if (WakeEvent)
+		WakeEvent->Trigger();
+}
+
+bool FALTelemetryWriter::FlushChunk()
+{
+	ChunkRecords.Reset();
+	const int32 NumRecords = Ring.Pop(ChunkRecords, MaxRecordsPerChunk);
+	if (NumRecords == 0)
+		return false;
+
+	const int32 UncompressedSize = NumRecords * sizeof(FALTelemetryRecord);
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+	CompressedChunk.SetNumUninitialized(CompressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, CompressedChunk.GetData(), CompressedSize, ChunkRecords.GetData(), UncompressedSize))
+	{
+		UE_LOG(LogALTelemetry, Warning, TEXT("Couldn't compress %d telemetry records, they are dropped"), NumRecords);
+		return true;
+	}
+
+	const uint32 ChunkHeader[2] = { static_cast<uint32>(NumRecords), static_cast<uint32>(CompressedSize) };
+	File->Write(reinterpret_cast<const uint8*>(ChunkHeader), sizeof(ChunkHeader));
+	File->Write(CompressedChunk.GetData(), CompressedSize);
+	return true;
+}
+
+void UALTelemetrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CachedWorld = GetWorld();
+
+	if (!CachedWorld->IsGameWorld() || !FParse::Param(FCommandLine::Get(), TEXT("ALTelemetry")))
+		return;
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("Telemetry") /
+		FString::Printf(TEXT("%s_%s.altm"), *CachedWorld->GetMapName(), *FDateTime::Now().ToString());
+	StartRecording(Filename);
+}
+
+void UALTelemetrySubsystem::Deinitialize()
+{
+	StopRecording();
+
+	Super::Deinitialize();
+}
+
+void UALTelemetrySubsystem::Record(EALTelemetryEvent Event, const AActor* Source)
+{
+	if (Source)
+		Record(Event, Source->GetUniqueID(), Source->GetActorLocation());
+}
+
+void UALTelemetrySubsystem::StartRecording(const FString& Filename)
+{
+	StopRecording();
+
+	Ring = MakeUnique<FALTelemetryRing>(RingCapacity);
+	Writer = MakeUnique<FALTelemetryWriter>(*Ring, Filename);
+}
+
+void UALTelemetrySubsystem::StopRecording()
+{
+	if (!Ring.IsValid())
+		return;
+
+	const uint32 NumDropped = Ring->GetNumDropped();
+	if (NumDropped > 0)
+		UE_LOG(LogALTelemetry, Warning, TEXT("%u telemetry records were dropped because the ring was full"), NumDropped);
+
+	// The writer flushes what's left in the ring when destroyed, so it has to go first
+	Writer.Reset();
+	Ring.Reset();
+}
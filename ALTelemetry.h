@@ -0,0 +1,168 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HAL/Runnable.h"
+#include "Templates/Atomic.h"
+#include "ALTelemetry.generated.h"
+
+// Stored as a byte in telemetry files, so only add new entries at the end
+enum class EALTelemetryEvent : uint8
+{
+	Jump,
+	DoubleJump,
+	Dash,
+	SlideStart,
+	SlideStop,
+	OilEnter,
+	OilExit,
+	ProjectileFire,
+	Push,
+
+	Count
+};
+
+// One event, written to disk exactly like this. Tools/ALTelemetry.py reads it as "<fIfffB3x".
+struct FALTelemetryRecord
+{
+	// World time in seconds
+	float Time;
+	// GetUniqueID() of the character, stable for the life of the session
+	uint32 SourceId;
+	float X;
+	float Y;
+	float Z;
+	EALTelemetryEvent Event;
+	uint8 Padding[3];
+};
+static_assert(sizeof(FALTelemetryRecord) == 24, "Telemetry records are read back with a fixed layout");
+
+// Single producer, single consumer ring of records. The game thread pushes and the flush thread pops, neither ever waits on
+// the other. A push into a full ring drops the record rather than blocking the frame.
+class FALTelemetryRing
+{
+public:
+
+	explicit FALTelemetryRing(uint32 CapacityPowerOfTwo);
+
+	// Game thread only
+	FORCEINLINE bool Push(const FALTelemetryRecord& Record)
+	{
+		const uint32 Write = WriteIndex.Load(EMemoryOrder::Relaxed);
+		if (Write - ReadIndex.Load() > Mask)
+		{
+			NumDropped++;
+			return false;
+		}
+
+		Records[Write & Mask] = Record;
+		WriteIndex.Store(Write + 1);
+		return true;
+	}
+
+	// Flush thread only. Appends up to MaxRecords and returns how many were appended.
+	int32 Pop(TArray<FALTelemetryRecord>& OutRecords, int32 MaxRecords);
+
+	// Only read from the game thread
+	uint32 GetNumDropped() const { return NumDropped; }
+
+private:
+
+	TArray<FALTelemetryRecord> Records;
+	uint32 Mask;
+
+	TAtomic<uint32> WriteIndex { 0 };
+	TAtomic<uint32> ReadIndex { 0 };
+	uint32 NumDropped = 0;
+};
+
+// Drains the ring every 100 ms on its own thread and appends it to the file as zlib compressed chunks.
+// The file starts with the magic "ALTM", a uint16 version and a uint16 record size. Each chunk is a uint32 record count,
+// a uint32 compressed size and the compressed records.
+class FALTelemetryWriter : public FRunnable
+{
+public:
+
+	FALTelemetryWriter(FALTelemetryRing& InRing, const FString& InFilename);
+	virtual ~FALTelemetryWriter();
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	static const uint32 Magic = 0x4D544C41; // "ALTM"
+	static const uint16 Version = 1;
+	static const int32 MaxRecordsPerChunk = 4096;
+
+private:
+
+	// Returns false when the ring was empty
+	bool FlushChunk();
+
+	FALTelemetryRing& Ring;
+	FString Filename;
+	TUniquePtr<IFileHandle> File;
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	TAtomic<bool> IsStopping { false };
+
+	TArray<FALTelemetryRecord> ChunkRecords;
+	TArray<uint8> CompressedChunk;
+};
+
+// Records gameplay events of every character in the world for playtest analysis. Off unless the game runs with -ALTelemetry,
+// in which case each world writes Saved/Telemetry/<Map>_<Time>.altm. Recording an event is a bounds check and a copy on the
+// game thread; compression and disk writes happen on the writer's thread.
+UCLASS()
+class UALTelemetrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	FORCEINLINE bool IsRecording() const { return Ring.IsValid(); }
+
+	FORCEINLINE void Record(EALTelemetryEvent Event, uint32 SourceId, const FVector& Location)
+	{
+		if (!Ring.IsValid())
+			return;
+
+		FALTelemetryRecord Entry;
+		Entry.Time = CachedWorld->GetTimeSeconds();
+		Entry.SourceId = SourceId;
+		Entry.X = Location.X;
+		Entry.Y = Location.Y;
+		Entry.Z = Location.Z;
+		Entry.Event = Event;
+		Entry.Padding[0] = Entry.Padding[1] = Entry.Padding[2] = 0;
+		Ring->Push(Entry);
+	}
+
+	void Record(EALTelemetryEvent Event, const AActor* Source);
+
+	// Starts recording to Filename even without -ALTelemetry, used by the benchmark
+	void StartRecording(const FString& Filename);
+	void StopRecording();
+
+	// Records that never made it to disk because the ring was full
+	uint32 GetNumDropped() const { return Ring.IsValid() ? Ring->GetNumDropped() : 0; }
+
+	// Records in flight, 2^16 of them is 1.5 MB
+	static const uint32 RingCapacity = 1 << 16;
+
+	// Counts the input recordings started in this world, so respawned characters get numbered files that don't depend on
+	// what ran earlier in the same editor session
+	int32 NextInputRecordingIndex() { return NumInputRecordings++; }
+
+private:
+
+	int32 NumInputRecordings = 0;
+
+	UPROPERTY(Transient)
+	UWorld* CachedWorld = nullptr;
+
+	TUniquePtr<FALTelemetryRing> Ring;
+	TUniquePtr<FALTelemetryWriter> Writer;
+};
@@ -0,0 +1,136 @@
+#include "Abilities/ALAbilitySet.h"
+#include "AALCharacter.h"
+#include "GameFramework/Actor.h"
+#include "Components/ALFireProjectileAbilityComponent.h"
+#include "Engine/World.h"
+#include "ALTelemetry.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogALAbility, Log, All);
+
+namespace ALAbilityAdapters
+{
+	static TMap<UClass*, FALAbilitySlotTable::FAdapter>& GetAdapters()
+	{
+		static TMap<UClass*, FALAbilitySlotTable::FAdapter> Adapters;
+		if (Adapters.Num() == 0)
+		{
+			// Ability components written before IALActivatableAbility
+			Adapters.Add(UALFireProjectileAbilityComponent::StaticClass(), [](UActorComponent* Component)
+			{
+				// Characters with a pooled projectile class take it from the projectile pool instead of spawning one
+				AALCharacter* Character = Cast<AALCharacter>(Component->GetOwner());
+				if (Character == nullptr || !Character->FirePooledProjectile())
+					static_cast<UALFireProjectileAbilityComponent*>(Component)->ThrowProjectile();
+
+				if (UALTelemetrySubsystem* Telemetry = Component->GetWorld()->GetSubsystem<UALTelemetrySubsystem>())
+					Telemetry->Record(EALTelemetryEvent::ProjectileFire, Component->GetOwner());
+			});
+		}
+		return Adapters;
+	}
+
+	static FALAbilitySlotTable::FAdapter FindAdapter(UClass* ComponentClass)
+	{
+		const TMap<UClass*, FALAbilitySlotTable::FAdapter>& Adapters = GetAdapters();
+		for (UClass* Class = ComponentClass; Class != nullptr; Class = Class->GetSuperClass())
+		{
+			if (const FALAbilitySlotTable::FAdapter* Adapter = Adapters.Find(Class))
+				return *Adapter;
+		}
+		return nullptr;
+	}
+}
+
+void FALAbilitySlotTable::RegisterAdapter(UClass* ComponentClass, FAdapter Adapter)
+{
+	ALAbilityAdapters::GetAdapters().Add(ComponentClass, Adapter);
+}
+
+void FALAbilitySlotTable::Build(AActor* Owner, const UALAbilitySet* AbilitySet)
+{
+	Components.Reset();
+	Adapters.Reset();
+
+	if (AbilitySet == nullptr)
+		return;
+
+	const int32 NumSlots = FMath::Min(AbilitySet->Slots.Num(), UALAbilitySet::MaxSlots);
+	Components.SetNumZeroed(NumSlots);
+	Adapters.SetNumZeroed(NumSlots);
+
+	for (int32 Slot = 0; Slot < NumSlots; Slot++)
+	{
+		const TSoftClassPtr<UActorComponent>& SoftComponentClass = AbilitySet->Slots[Slot].ComponentClass;
+		UClass* ComponentClass = SoftComponentClass.Get();
+		if (ComponentClass == nullptr)
+		{
+			// Streamed in by UALAssetStreamingSubsystem before the table is built
+			if (!SoftComponentClass.IsNull())
+				UE_LOG(LogALAbility, Warning, TEXT("%s: %s isn't loaded, ability slot %d stays empty"), *GetNameSafe(AbilitySet), *SoftComponentClass.ToString(), Slot);
+			continue;
+		}
+
+		UActorComponent* Component = Owner->FindComponentByClass(ComponentClass);
+		if (Component == nullptr)
+		{
+			Component = NewObject<UActorComponent>(Owner, ComponentClass);
+			Component->RegisterComponent();
+		}
+
+		Components[Slot] = Component;
+
+		if (!ComponentClass->ImplementsInterface(UALActivatableAbility::StaticClass()))
+		{
+			Adapters[Slot] = ALAbilityAdapters::FindAdapter(ComponentClass);
+			if (Adapters[Slot] == nullptr)
+				UE_LOG(LogALAbility, Warning, TEXT("%s: %s can't be activated from ability slot %d"), *GetNameSafe(AbilitySet), *ComponentClass->GetName(), Slot);
+		}
+	}
+}
+
+void FALAbilitySlotTable::BuildLegacy(AActor* Owner)
+{
+	Components.Reset();
+	Adapters.Reset();
+
+	UActorComponent* Component = Owner->FindComponentByClass<UALFireProjectileAbilityComponent>();
+	if (Component == nullptr)
+		return;
+
+	Components.Add(Component);
+	Adapters.Add(ALAbilityAdapters::FindAdapter(Component->GetClass()));
+}
+
+int32 FALAbilitySlotTable::FindSlot(UClass* ComponentClass) const
+{
+	return Components.IndexOfByPredicate([ComponentClass](const UActorComponent* Component) { return Component && Component->IsA(ComponentClass); });
+}
+
+bool FALAbilitySlotTable::Activate(int32 Slot) const
+{
+	if (!Components.IsValidIndex(Slot) || Components[Slot] == nullptr)
+		return false;
+
+	if (Adapters[Slot] != nullptr)
+	{
+		Adapters[Slot](Components[Slot]);
+		return true;
+	}
+
+	if (IALActivatableAbility* Ability = Cast<IALActivatableAbility>(Components[Slot]))
+	{
+		Ability->ActivateAbility();
+		return true;
+	}
+
+	return false;
+}
+
+void FALAbilitySlotTable::ResetAbilities() const
+{
+	for (UActorComponent* Component : Components)
+	{
+		if (IALActivatableAbility* Ability = Cast<IALActivatableAbility>(Component))
+			Ability->ResetAbility();
+	}
+}
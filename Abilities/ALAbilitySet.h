@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "UObject/Interface.h"
+#include "ALAbilitySet.generated.h"
+
+UINTERFACE(MinimalAPI)
+class UALActivatableAbility : public UInterface
+{
+	GENERATED_BODY()
+};
+
+// Implemented by ability components so an ability slot can activate them without knowing their type
+class IALActivatableAbility
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void ActivateAbility() = 0;
+
+	// Called when the character is reused from UALCharacterPoolSubsystem, to clear cooldowns and anything else left from its last life
+	virtual void ResetAbility() {}
+};
+
+USTRUCT(BlueprintType)
+struct FALAbilitySlotDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, Category = "Ability", meta = (ToolTip = "Action mapping from the project input settings that activates this slot"))
+	FName InputActionName;
+
+	// Soft, so the ability's assets are streamed in with the character's archetype instead of loading with the set
+	UPROPERTY(EditDefaultsOnly, Category = "Ability", meta = (ToolTip = "Used if the character already has one, added to the character otherwise"))
+	TSoftClassPtr<UActorComponent> ComponentClass;
+};
+
+// Which abilities a character has and which input activates each one. Slot order is the order of Slots.
+UCLASS(BlueprintType)
+class UALAbilitySet : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	static const int32 MaxSlots = 8;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Ability", meta = (ToolTip = "Only the first 8 slots are used"))
+	TArray<FALAbilitySlotDefinition> Slots;
+};
+
+// The components for one ability set, resolved once so activating a slot is an array lookup.
+// Components that don't implement IALActivatableAbility are activated through a native adapter registered for their class.
+USTRUCT()
+struct FALAbilitySlotTable
+{
+	GENERATED_BODY()
+
+	typedef void (*FAdapter)(UActorComponent* Component);
+
+	void Build(AActor* Owner, const UALAbilitySet* AbilitySet);
+	// For characters without an ability set: their own UALFireProjectileAbilityComponent in slot 0, if they have one
+	void BuildLegacy(AActor* Owner);
+	bool Activate(int32 Slot) const;
+	void ResetAbilities() const;
+
+	int32 Num() const { return Components.Num(); }
+	UActorComponent* GetComponent(int32 Slot) const { return Components.IsValidIndex(Slot) ? Components[Slot] : nullptr; }
+	// First slot holding a ComponentClass, INDEX_NONE if there's none
+	int32 FindSlot(UClass* ComponentClass) const;
+
+	static void RegisterAdapter(UClass* ComponentClass, FAdapter Adapter);
+
+private:
+
+	// Null where the slot's component couldn't be created
+	UPROPERTY()
+	TArray<UActorComponent*> Components;
+
+	TArray<FAdapter> Adapters;
+};
@@ -0,0 +1,109 @@
+#include "Components/ALCameraRigComponent.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "Engine/World.h"
+
+UALCameraRigComponent::UALCameraRigComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UALCameraRigComponent::SetupRig(USpringArmComponent* InSpringArm, USpringArmComponent* InAimSpringArm)
+{
+	SpringArm = InSpringArm;
+	AimSpringArm = InAimSpringArm;
+
+	// The rig does the probing, and the aim arm only holds the aim pose
+	SpringArm->bDoCollisionTest = false;
+	AimSpringArm->bDoCollisionTest = false;
+	AimSpringArm->PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UALCameraRigComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (SpringArm == nullptr || AimSpringArm == nullptr)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	BaseRelativeLocation = SpringArm->GetRelativeLocation();
+	BaseSocketOffset = SpringArm->SocketOffset;
+
+	DefaultZoom = FMath::Clamp(SpringArm->TargetArmLength, MinArmLength, MaxArmLength);
+	TargetZoom = DefaultZoom;
+	CurrentZoom = TargetZoom;
+
+	// The arm has to see this frame's length
+	SpringArm->PrimaryComponentTick.AddPrerequisite(this, PrimaryComponentTick);
+}
+
+void UALCameraRigComponent::SetAiming(bool NewIsAiming)
+{
+	IsAiming = NewIsAiming;
+}
+
+void UALCameraRigComponent::ResetRig()
+{
+	IsAiming = false;
+	AimAlpha = 0.f;
+	TargetZoom = DefaultZoom;
+	CurrentZoom = TargetZoom;
+	ProbedArmLength = TNumericLimits<float>::Max();
+	ProbeHandle = FTraceHandle();
+}
+
+void UALCameraRigComponent::ZoomIn()
+{
+	TargetZoom = FMath::Clamp(TargetZoom - ZoomStep, MinArmLength, MaxArmLength);
+}
+
+void UALCameraRigComponent::ZoomOut()
+{
+	TargetZoom = FMath::Clamp(TargetZoom + ZoomStep, MinArmLength, MaxArmLength);
+}
+
+void UALCameraRigComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	CurrentZoom = FMath::FInterpTo(CurrentZoom, TargetZoom, DeltaTime, ZoomInterpSpeed);
+	AimAlpha = FMath::FInterpConstantTo(AimAlpha, IsAiming ? 1.f : 0.f, DeltaTime, AimBlendSpeed);
+
+	SpringArm->SetRelativeLocation(FMath::Lerp(BaseRelativeLocation, AimSpringArm->GetRelativeLocation(), AimAlpha));
+	SpringArm->SocketOffset = FMath::Lerp(BaseSocketOffset, AimSpringArm->SocketOffset, AimAlpha);
+
+	const float DesiredArmLength = FMath::Lerp(CurrentZoom, AimSpringArm->TargetArmLength, AimAlpha);
+	SpringArm->TargetArmLength = UpdateProbe(DeltaTime, DesiredArmLength);
+}
+
+float UALCameraRigComponent::UpdateProbe(float DeltaTime, float DesiredArmLength)
+{
+	UWorld* World = GetWorld();
+
+	// Last frame's sweep. If it isn't done yet the previous result is kept.
+	FTraceDatum ProbeResult;
+	if (ProbeHandle.IsValid() && World->QueryTraceData(ProbeHandle, ProbeResult))
+	{
+		const float SweptLength = (ProbeResult.End - ProbeResult.Start).Size();
+		const float FreeLength = ProbeResult.OutHits.Num() > 0 && ProbeResult.OutHits[0].bBlockingHit ? ProbeResult.OutHits[0].Time * SweptLength : TNumericLimits<float>::Max();
+
+		if (FreeLength < ProbedArmLength)
+			ProbedArmLength = FreeLength;
+		// Coming back out after an obstruction
+		else if (ProbedArmLength < DesiredArmLength - 1.f)
+			ProbedArmLength = FMath::FInterpTo(ProbedArmLength, FMath::Min(FreeLength, DesiredArmLength), DeltaTime, ProbeRecoverySpeed);
+		else
+			ProbedArmLength = TNumericLimits<float>::Max();
+	}
+
+	const FVector Start = SpringArm->GetComponentLocation() + SpringArm->TargetOffset;
+	const FVector End = Start - SpringArm->GetTargetRotation().Vector() * DesiredArmLength;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ALCameraRigProbe), false, GetOwner());
+	ProbeHandle = World->AsyncSweepByChannel(EAsyncTraceType::Single, Start, End, ProbeChannel, FCollisionShape::MakeSphere(ProbeRadius), QueryParams);
+
+	return FMath::Min(DesiredArmLength, ProbedArmLength);
+}
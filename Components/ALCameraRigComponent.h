@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "ALCameraRigComponent.generated.h"
+
+class USpringArmComponent;
+
+// Drives the character's camera spring arms. The camera stays attached to the main arm the whole time: aiming blends the arm
+// towards the pose of the aim arm, and zoom eases between MinArmLength and MaxArmLength.
+// The arm's own collision test is turned off. The rig sweeps for obstructions with an async trace instead and uses the result
+// the frame after, so the game thread never waits on the sweep.
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class UALCameraRigComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UALCameraRigComponent();
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	void SetupRig(USpringArmComponent* InSpringArm, USpringArmComponent* InAimSpringArm);
+
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void SetAiming(bool NewIsAiming);
+
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void ZoomIn();
+
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void ZoomOut();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Camera")
+	float GetAimAlpha() const { return AimAlpha; }
+
+	// Drops out of aiming and settles the zoom and probe straight away, for a character handed to another player
+	void ResetRig();
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
+	float MinArmLength = 150.f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
+	float MaxArmLength = 400.f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera", meta = (ToolTip = "How much one zoom input changes the arm length"))
+	float ZoomStep = 20.f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
+	float ZoomInterpSpeed = 10.f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera")
+	float AimBlendSpeed = 8.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera: Collision")
+	float ProbeRadius = 12.f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera: Collision")
+	TEnumAsByte<ECollisionChannel> ProbeChannel = ECC_Camera;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Camera: Collision", meta = (ToolTip = "How fast the arm extends again once an obstruction is gone. Pulling in is always instant"))
+	float ProbeRecoverySpeed = 6.f;
+
+private:
+
+	float UpdateProbe(float DeltaTime, float DesiredArmLength);
+
+	UPROPERTY()
+	USpringArmComponent* SpringArm;
+
+	UPROPERTY()
+	USpringArmComponent* AimSpringArm;
+
+	FVector BaseRelativeLocation;
+	FVector BaseSocketOffset;
+
+	// The arm length the character was set up with, which ResetRig zooms back to
+	float DefaultZoom = 400.f;
+	float TargetZoom = 400.f;
+	float CurrentZoom = 400.f;
+	float AimAlpha = 0.f;
+	bool IsAiming = false;
+
+	float ProbedArmLength = TNumericLimits<float>::Max();
+	FTraceHandle ProbeHandle;
+};
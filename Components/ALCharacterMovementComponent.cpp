@@ -0,0 +1,470 @@
+#include "Components/ALCharacterMovementComponent.h"
+#include "AALCharacter.h"
+#include "ALMovementRules.h"
+#include "ALStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("PhysDash"), STAT_ALPhysDash, STATGROUP_ALCharacter);
+DECLARE_CYCLE_STAT(TEXT("PhysGlide"), STAT_ALPhysGlide, STATGROUP_ALCharacter);
+
+// FLAG_Custom_0..3 are free for game use
+static const uint8 SprintFlag = FSavedMove_Character::FLAG_Custom_0;
+static const uint8 SneakFlag = FSavedMove_Character::FLAG_Custom_1;
+static const uint8 DashFlag = FSavedMove_Character::FLAG_Custom_2;
+static const uint8 DoubleJumpFlag = FSavedMove_Character::FLAG_Custom_3;
+
+UALCharacterMovementComponent::UALCharacterMovementComponent()
+{
+	WantsToSprint = false;
+	WantsToSneak = false;
+	WantsToDash = false;
+	WantsToDoubleJump = false;
+}
+
+AALCharacter* UALCharacterMovementComponent::GetALCharacter() const
+{
+	return Cast<AALCharacter>(CharacterOwner);
+}
+
+float UALCharacterMovementComponent::GetMaxSpeed() const
+{
+	const AALCharacter* Character = GetALCharacter();
+	if (Character == nullptr)
+		return Super::GetMaxSpeed();
+
+	switch (MovementMode)
+	{
+	case MOVE_Walking:
+	case MOVE_NavWalking:
+	case MOVE_Falling:
+		break;
+	case MOVE_Custom:
+		if (CustomMovementMode == ALMOVE_Glide)
+			break;
+		return Super::GetMaxSpeed();
+	default:
+		return Super::GetMaxSpeed();
+	}
+
+	float Speed = MaxWalkSpeed;
+	if (IsSlowed)
+		Speed = Character->SlowSpeed;
+	else if (WantsToSprint)
+		Speed = ALMovementRules::SprintWalkSpeed(MaxWalkSpeed, Character->IsOnOil, true, Character->SprintSpeed, Character->GlidSpeed);
+	else if (WantsToSneak)
+		Speed = Character->SneakSpeed;
+
+	return FMath::Max((Speed + AdditiveSpeed) * SpeedMultiplier, 0.f);
+}
+
+void UALCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	WantsToSprint = (Flags & SprintFlag) != 0;
+	WantsToSneak = (Flags & SneakFlag) != 0;
+	WantsToDash = (Flags & DashFlag) != 0;
+	WantsToDoubleJump = (Flags & DoubleJumpFlag) != 0;
+}
+
+void UALCharacterMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// Input has been processed for this frame by now, and the movement input is consumed in Super
+	if (AALCharacter* Character = GetALCharacter())
+		Character->ProcessInputStage(DeltaTime);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// The mesh ticks after this component, so the animation always sees this frame's movement
+	if (AALCharacter* Character = GetALCharacter())
+	{
+		Character->PublishAnimSnapshot(DeltaTime);
+		Character->UpdateCosmeticMovementState();
+		Character->SetPresentationOffset(GetPresentationOffset());
+	}
+}
+
+void UALCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	AALCharacter* Character = GetALCharacter();
+	if (Character == nullptr)
+		return;
+
+	// Runs for every move on the owning client and the server alike, so both end up in the same state
+	Character->AdvanceCoyoteTime(DeltaSeconds);
+	Character->UpdateMoveSurface(DeltaSeconds);
+
+	if (Character->IsSprinting != WantsToSprint)
+		Character->ApplySprinting(WantsToSprint);
+
+	if (Character->ReturnIfSneaking() != WantsToSneak)
+		Character->ApplySneaking(WantsToSneak);
+
+	if (WantsToDoubleJump)
+	{
+		WantsToDoubleJump = false;
+		Character->PerformDoubleJump();
+	}
+
+	if (WantsToDash)
+	{
+		WantsToDash = false;
+		Character->PerformDash();
+	}
+
+	UpdateGlideMode(Character, DeltaSeconds);
+}
+
+bool UALCharacterMovementComponent::IsMovingOnGround() const
+{
+	return Super::IsMovingOnGround() || (IsInALMovementMode(ALMOVE_Glide) && UpdatedComponent);
+}
+
+void UALCharacterMovementComponent::UpdateGlideMode(const AALCharacter* Character, float DeltaSeconds)
+{
+	const bool IsGlideMode = IsInALMovementMode(ALMOVE_Glide);
+	const bool CanGlide = Character->IsOnOil && Character->IsSprinting;
+
+	// Letting go of sprint or leaving the oil starts the slide timer over
+	if (!CanGlide)
+		GlideTime = 0.f;
+
+	if (IsGlideMode && (!CanGlide || GlideTime >= Character->SlideTimer))
+		SetMovementMode(MOVE_Walking);
+	else if (!IsGlideMode && MovementMode == MOVE_Walking && CanGlide && GlideTime < Character->SlideTimer)
+	{
+		AbilityStep.Reset();
+		SetMovementMode(MOVE_Custom, ALMOVE_Glide);
+	}
+}
+
+void UALCharacterMovementComponent::ResetForReuse()
+{
+	WantsToSprint = false;
+	WantsToSneak = false;
+	WantsToDash = false;
+	WantsToDoubleJump = false;
+
+	IsSlowed = false;
+	AdditiveSpeed = 0.f;
+	SpeedMultiplier = 1.f;
+
+	DashDirection = FVector::ZeroVector;
+	DashDistance = 0.f;
+	DashDuration = 0.f;
+	DashElapsed = 0.f;
+	GlideTime = 0.f;
+	AbilityStep.Reset();
+
+	StopMovementImmediately();
+	ClearAccumulatedForces();
+	SetMovementMode(DefaultLandMovementMode);
+
+	// Moves saved for the last owner mean nothing to the next one
+	ResetPredictionData_Client();
+	ResetPredictionData_Server();
+}
+
+void UALCharacterMovementComponent::StartDash(const FVector& Direction, float Distance, float PeakSpeed)
+{
+	if (Distance <= 0.f || PeakSpeed <= 0.f)
+		return;
+
+	// The ease-out curve starts at twice its average speed, so this is the duration that starts it at PeakSpeed
+	DashDirection = Direction.GetSafeNormal();
+	DashDistance = Distance;
+	DashDuration = 2.f * Distance / PeakSpeed;
+	DashElapsed = 0.f;
+	AbilityStep.Reset();
+
+	Velocity = DashDirection * PeakSpeed;
+	SetMovementMode(MOVE_Custom, ALMOVE_Dash);
+}
+
+int32 UALCharacterMovementComponent::GetNumSubsteps(float Distance) const
+{
+	return FMath::Clamp(FMath::CeilToInt(Distance / MaxStepDistance), 1, MaxSubsteps);
+}
+
+FVector UALCharacterMovementComponent::GetPresentationOffset() const
+{
+	// Simulated proxies already get the engine's network smoothing on the mesh, and nobody looks through a remote player's camera
+	if (MovementMode != MOVE_Custom || CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy || !CharacterOwner->IsLocallyControlled())
+		return FVector::ZeroVector;
+
+	// Teleported or moved by something else since the last step
+	if (!UpdatedComponent->GetComponentLocation().Equals(StepEndLocation))
+		return FVector::ZeroVector;
+
+	// Between the last two steps, which draws the character up to one step behind its capsule
+	return (StepEndLocation - StepStartLocation) * (AbilityStep.GetAlpha(AbilityStepTime) - 1.f);
+}
+
+void UALCharacterMovementComponent::PhysCustom(float DeltaTime, int32 Iterations)
+{
+	const uint8 Mode = CustomMovementMode;
+	if (Mode != ALMOVE_Dash && Mode != ALMOVE_Glide)
+	{
+		Super::PhysCustom(DeltaTime, Iterations);
+		return;
+	}
+
+	const int32 NumSteps = AbilityStep.Advance(DeltaTime, AbilityStepTime, MaxAbilitySteps);
+	for (int32 Step = 0; Step < NumSteps; Step++)
+	{
+		StepStartLocation = UpdatedComponent->GetComponentLocation();
+
+		if (Mode == ALMOVE_Dash)
+			PhysDash(AbilityStepTime, Iterations);
+		else
+			PhysGlide(AbilityStepTime, Iterations);
+
+		StepEndLocation = UpdatedComponent->GetComponentLocation();
+
+		// The rest of the move runs in whatever mode the dash or glide ended in
+		if (!IsInALMovementMode(static_cast<EALCustomMovementMode>(Mode)))
+		{
+			const float RemainingTime = (NumSteps - Step - 1) * AbilityStepTime + AbilityStep.Remainder;
+			AbilityStep.Reset();
+			StartNewPhysics(RemainingTime, Iterations + 1);
+			return;
+		}
+	}
+}
+
+void UALCharacterMovementComponent::PhysDash(float DeltaTime, int32 Iterations)
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALPhysDash);
+
+	if (DeltaTime < MIN_TICK_TIME)
+		return;
+
+	// Distance covered follows 1 - (1 - t)^2, so the dash always covers exactly DashDistance however the frames fall
+	auto DashCurve = [](float Alpha) { return 1.f - FMath::Square(1.f - Alpha); };
+
+	const float PrevAlpha = DashDuration > 0.f ? DashElapsed / DashDuration : 1.f;
+	DashElapsed = FMath::Min(DashElapsed + DeltaTime, DashDuration);
+	const float Alpha = DashDuration > 0.f ? DashElapsed / DashDuration : 1.f;
+
+	const float Distance = DashDistance * (DashCurve(Alpha) - DashCurve(PrevAlpha));
+	const int32 NumSteps = GetNumSubsteps(Distance);
+	const FVector StepDelta = DashDirection * (Distance / NumSteps);
+	const FQuat Rotation = UpdatedComponent->GetComponentQuat();
+
+	bool IsBlocked = false;
+	for (int32 Step = 0; Step < NumSteps && !IsBlocked; Step++)
+	{
+		FHitResult Hit(1.f);
+		SafeMoveUpdatedComponent(StepDelta, Rotation, true, Hit);
+
+		if (Hit.IsValidBlockingHit())
+		{
+			HandleImpact(Hit, DeltaTime, StepDelta);
+			// Slides along what it hit for the rest of the step, but a wall straight ahead ends the dash
+			IsBlocked = SlideAlongSurface(StepDelta, 1.f - Hit.Time, Hit.Normal, Hit, true) < KINDA_SMALL_NUMBER;
+		}
+	}
+
+	if (!IsBlocked && Alpha < 1.f)
+	{
+		Velocity = DashDirection * (2.f * DashDistance / DashDuration) * (1.f - Alpha);
+		return;
+	}
+
+	Velocity = IsBlocked ? FVector::ZeroVector : DashDirection * DashExitSpeed;
+	SetMovementMode(MOVE_Falling);
+}
+
+void UALCharacterMovementComponent::PhysGlide(float DeltaTime, int32 Iterations)
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALPhysGlide);
+
+	if (DeltaTime < MIN_TICK_TIME)
+		return;
+
+	const AALCharacter* Character = GetALCharacter();
+	if (Character == nullptr)
+	{
+		SetMovementMode(MOVE_Walking);
+		return;
+	}
+
+	GlideTime += DeltaTime;
+
+	// Input along the glide keeps full strength, input across it is divided by SlideValue so the character can't turn sharply on oil
+	const FVector Forward = Velocity.SizeSquared2D() > KINDA_SMALL_NUMBER ? Velocity.GetSafeNormal2D() : UpdatedComponent->GetForwardVector().GetSafeNormal2D();
+	const FVector Input = FVector(Acceleration.X, Acceleration.Y, 0.f);
+	const FVector ForwardInput = Forward * (Input | Forward);
+	const FVector SavedAcceleration = Acceleration;
+	Acceleration = ForwardInput + (Input - ForwardInput) / FMath::Max(Character->SlideValue, 1.f);
+
+	CalcVelocity(DeltaTime, GlideFriction, false, GetMaxBrakingDeceleration());
+	Acceleration = SavedAcceleration;
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	const int32 NumSteps = GetNumSubsteps(Velocity.Size2D() * DeltaTime);
+	const float StepTime = DeltaTime / NumSteps;
+
+	for (int32 Step = 0; Step < NumSteps; Step++)
+	{
+		MoveAlongFloor(Velocity, StepTime);
+		FindFloor(UpdatedComponent->GetComponentLocation(), CurrentFloor, false);
+
+		if (!CurrentFloor.IsWalkableFloor())
+		{
+			SetMovementMode(MOVE_Falling);
+			return;
+		}
+
+		AdjustFloorHeight();
+	}
+
+	// Anything hit along the way takes speed off the glide
+	if (!bJustTeleported)
+		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / DeltaTime;
+
+	MaintainHorizontalGroundVelocity();
+}
+
+FNetworkPredictionData_Client* UALCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UALCharacterMovementComponent* MutableThis = const_cast<UALCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_AL(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void FSavedMove_AL::Clear()
+{
+	Super::Clear();
+
+	SavedWantsToSprint = false;
+	SavedWantsToSneak = false;
+	SavedWantsToDash = false;
+	SavedWantsToDoubleJump = false;
+	SavedJumpCounter = 0.f;
+	SavedDashCounter = 0.f;
+	SavedDashDirection = FVector::ZeroVector;
+	SavedDashDistance = 0.f;
+	SavedDashDuration = 0.f;
+	SavedDashElapsed = 0.f;
+	SavedGlideTime = 0.f;
+	SavedAbilityStepRemainder = 0.f;
+	SavedTimeSinceLeftGround = -1.f;
+	SavedIsOnOil = false;
+	SavedOilTime = 0.f;
+	SavedIsSlowed = false;
+	SavedAdditiveSpeed = 0.f;
+	SavedSpeedMultiplier = 1.f;
+}
+
+uint8 FSavedMove_AL::GetCompressedFlags() const
+{
+	uint8 Flags = Super::GetCompressedFlags();
+
+	if (SavedWantsToSprint)
+		Flags |= SprintFlag;
+	if (SavedWantsToSneak)
+		Flags |= SneakFlag;
+	if (SavedWantsToDash)
+		Flags |= DashFlag;
+	if (SavedWantsToDoubleJump)
+		Flags |= DoubleJumpFlag;
+
+	return Flags;
+}
+
+bool FSavedMove_AL::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* Character, float MaxDelta) const
+{
+	const FSavedMove_AL* NewALMove = static_cast<const FSavedMove_AL*>(NewMove.Get());
+
+	// A dash or double jump has to arrive as its own move or the server would apply it at the wrong time
+	if (SavedWantsToDash || SavedWantsToDoubleJump || NewALMove->SavedWantsToDash || NewALMove->SavedWantsToDoubleJump)
+		return false;
+
+	if (SavedWantsToSprint != NewALMove->SavedWantsToSprint || SavedWantsToSneak != NewALMove->SavedWantsToSneak)
+		return false;
+
+	if (SavedIsOnOil != NewALMove->SavedIsOnOil || SavedIsSlowed != NewALMove->SavedIsSlowed || SavedAdditiveSpeed != NewALMove->SavedAdditiveSpeed || SavedSpeedMultiplier != NewALMove->SavedSpeedMultiplier)
+		return false;
+
+	return Super::CanCombineWith(NewMove, Character, MaxDelta);
+}
+
+bool FSavedMove_AL::IsImportantMove(const FSavedMovePtr& LastAckedMove) const
+{
+	if (SavedWantsToDash || SavedWantsToDoubleJump)
+		return true;
+
+	return Super::IsImportantMove(LastAckedMove);
+}
+
+void FSavedMove_AL::SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+	const UALCharacterMovementComponent* Movement = CastChecked<UALCharacterMovementComponent>(Character->GetCharacterMovement());
+	SavedWantsToSprint = Movement->WantsToSprint;
+	SavedWantsToSneak = Movement->WantsToSneak;
+	SavedWantsToDash = Movement->WantsToDash;
+	SavedWantsToDoubleJump = Movement->WantsToDoubleJump;
+	SavedDashDirection = Movement->DashDirection;
+	SavedDashDistance = Movement->DashDistance;
+	SavedDashDuration = Movement->DashDuration;
+	SavedDashElapsed = Movement->DashElapsed;
+	SavedGlideTime = Movement->GlideTime;
+	SavedAbilityStepRemainder = Movement->AbilityStep.Remainder;
+	SavedIsSlowed = Movement->IsSlowed;
+	SavedAdditiveSpeed = Movement->AdditiveSpeed;
+	SavedSpeedMultiplier = Movement->SpeedMultiplier;
+
+	const FALMovementRuleState State = CastChecked<AALCharacter>(Character)->GetMovementRuleState();
+	SavedJumpCounter = State.JumpCounter;
+	SavedDashCounter = State.DashCounter;
+	SavedIsOnOil = State.IsOnOil;
+	SavedOilTime = State.OilTime;
+	SavedTimeSinceLeftGround = CastChecked<AALCharacter>(Character)->GetTimeSinceLeftGround();
+}
+
+void FSavedMove_AL::PrepMoveFor(ACharacter* Character)
+{
+	Super::PrepMoveFor(Character);
+
+	UALCharacterMovementComponent* Movement = CastChecked<UALCharacterMovementComponent>(Character->GetCharacterMovement());
+	Movement->WantsToSprint = SavedWantsToSprint;
+	Movement->WantsToSneak = SavedWantsToSneak;
+	Movement->WantsToDash = SavedWantsToDash;
+	Movement->WantsToDoubleJump = SavedWantsToDoubleJump;
+	Movement->DashDirection = SavedDashDirection;
+	Movement->DashDistance = SavedDashDistance;
+	Movement->DashDuration = SavedDashDuration;
+	Movement->DashElapsed = SavedDashElapsed;
+	Movement->GlideTime = SavedGlideTime;
+	Movement->AbilityStep.Remainder = SavedAbilityStepRemainder;
+	Movement->IsSlowed = SavedIsSlowed;
+	Movement->AdditiveSpeed = SavedAdditiveSpeed;
+	Movement->SpeedMultiplier = SavedSpeedMultiplier;
+
+	AALCharacter* ALCharacter = CastChecked<AALCharacter>(Character);
+	FALMovementRuleState State = ALCharacter->GetMovementRuleState();
+	State.JumpCounter = SavedJumpCounter;
+	State.DashCounter = SavedDashCounter;
+	State.IsOnOil = SavedIsOnOil;
+	State.OilTime = SavedOilTime;
+	ALCharacter->SetMovementRuleState(State);
+	ALCharacter->SetTimeSinceLeftGround(SavedTimeSinceLeftGround);
+}
+
+FNetworkPredictionData_Client_AL::FNetworkPredictionData_Client_AL(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_AL::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_AL());
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ALFixedStep.h"
+#include "ALCharacterMovementComponent.generated.h"
+
+class AALCharacter;
+
+// CustomMovementMode values used with MOVE_Custom
+enum EALCustomMovementMode
+{
+	ALMOVE_Dash = 0,
+	ALMOVE_Glide = 1
+};
+
+// Sprint, sneak, dash and double jump as part of the predicted move, so the owning client runs them straight away and the
+// server replays them from the same move instead of correcting the client afterwards.
+// Walk speed is worked out in GetMaxSpeed from these flags instead of being written to MaxWalkSpeed.
+// Dashing and gliding on oil are their own movement modes. Both move in sweeps of at most MaxStepDistance, so their cost per
+// frame is bounded and they can't tunnel at the high speeds they run at.
+// Both also advance in fixed steps of AbilityStepTime, so a dash or glide plays out the same on a 30 Hz server as on a 144 Hz client.
+// The local player sees the mesh and camera interpolated between the last two steps.
+UCLASS()
+class UALCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_AL;
+
+public:
+
+	UALCharacterMovementComponent();
+
+	virtual float GetMaxSpeed() const override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual bool IsMovingOnGround() const override;
+
+	// Back to how a freshly spawned character starts, for characters reused from UALCharacterPoolSubsystem
+	void ResetForReuse();
+
+	// Covers Distance along Direction, starting at PeakSpeed and easing out to a stop
+	void StartDash(const FVector& Direction, float Distance, float PeakSpeed);
+
+	void SetWantsToSprint(bool NewWantsToSprint) { WantsToSprint = NewWantsToSprint; }
+	void SetWantsToSneak(bool NewWantsToSneak) { WantsToSneak = NewWantsToSneak; }
+	void RequestDash() { WantsToDash = true; }
+	void RequestDoubleJump() { WantsToDoubleJump = true; }
+
+	// Slowing and speed modifiers come from status effects rather than from input. Each saved move keeps the values it ran with,
+	// so a replayed move moves at the speed it was predicted with. The server runs its own status effects and corrects the rest.
+	void SetSlowed(bool NewIsSlowed) { IsSlowed = NewIsSlowed; }
+	void SetSpeedModifiers(float NewAdditiveSpeed, float NewSpeedMultiplier) { AdditiveSpeed = NewAdditiveSpeed; SpeedMultiplier = NewSpeedMultiplier; }
+
+	bool GetWantsToSprint() const { return WantsToSprint; }
+	bool GetWantsToSneak() const { return WantsToSneak; }
+	bool IsInALMovementMode(EALCustomMovementMode Mode) const { return MovementMode == MOVE_Custom && CustomMovementMode == Mode; }
+
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Dashing", meta = (ToolTip = "Longest sweep a dash or glide makes in one go. Faster movement is split into more sweeps", ClampMin = "1.0"))
+	float MaxStepDistance = 50.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Dashing", meta = (ToolTip = "Most sweeps per frame. Past this the sweeps get longer instead of more numerous", ClampMin = "1"))
+	int32 MaxSubsteps = 8;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Dashing", meta = (ToolTip = "Length of one dash or glide step. They run in steps of this length whatever the frame rate", ClampMin = "0.001"))
+	float AbilityStepTime = 1.f / 60.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Dashing", meta = (ToolTip = "Most dash or glide steps in one move. Time past this is dropped, so a hitch slows the dash down instead of running it all at once", ClampMin = "1"))
+	int32 MaxAbilitySteps = 4;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Dashing", meta = (ToolTip = "Speed the character falls on with once the dash is over"))
+	float DashExitSpeed = 600.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Sliding", meta = (ToolTip = "Friction while gliding on oil. Walking friction is GroundFriction"))
+	float GlideFriction = 0.5f;
+
+protected:
+
+	virtual void PhysCustom(float DeltaTime, int32 Iterations) override;
+
+private:
+
+	AALCharacter* GetALCharacter() const;
+
+	void PhysDash(float DeltaTime, int32 Iterations);
+	void PhysGlide(float DeltaTime, int32 Iterations);
+	void UpdateGlideMode(const AALCharacter* Character, float DeltaSeconds);
+	int32 GetNumSubsteps(float Distance) const;
+	FVector GetPresentationOffset() const;
+
+	uint8 WantsToSprint : 1;
+	uint8 WantsToSneak : 1;
+	uint8 WantsToDash : 1;
+	uint8 WantsToDoubleJump : 1;
+
+	bool IsSlowed = false;
+	float AdditiveSpeed = 0.f;
+	float SpeedMultiplier = 1.f;
+
+	FVector DashDirection = FVector::ZeroVector;
+	float DashDistance = 0.f;
+	float DashDuration = 0.f;
+	float DashElapsed = 0.f;
+
+	// Time spent gliding since the glide started. Gliding stops once it passes the character's SlideTimer.
+	float GlideTime = 0.f;
+
+	// Time toward the next dash or glide step, and where the capsule was before and after the last one
+	FALFixedStep AbilityStep;
+	FVector StepStartLocation = FVector::ZeroVector;
+	FVector StepEndLocation = FVector::ZeroVector;
+};
+
+class FSavedMove_AL : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* Character, float MaxDelta) const override;
+	virtual bool IsImportantMove(const FSavedMovePtr& LastAckedMove) const override;
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* Character) override;
+
+private:
+
+	uint8 SavedWantsToSprint : 1;
+	uint8 SavedWantsToSneak : 1;
+	uint8 SavedWantsToDash : 1;
+	uint8 SavedWantsToDoubleJump : 1;
+
+	// Restored before the move is replayed after a correction, so a replayed dash or double jump doesn't count twice
+	float SavedJumpCounter;
+	float SavedDashCounter;
+
+	FVector SavedDashDirection;
+	float SavedDashDistance;
+	float SavedDashDuration;
+	float SavedDashElapsed;
+	float SavedGlideTime;
+	float SavedAbilityStepRemainder;
+	float SavedTimeSinceLeftGround;
+	uint8 SavedIsOnOil : 1;
+	float SavedOilTime;
+
+	uint8 SavedIsSlowed : 1;
+	float SavedAdditiveSpeed;
+	float SavedSpeedMultiplier;
+};
+
+class FNetworkPredictionData_Client_AL : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_AL(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
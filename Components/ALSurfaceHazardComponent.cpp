@@ -0,0 +1,88 @@
+#include "Components/ALSurfaceHazardComponent.h"
+#include "ALStats.h"
+#include "Components/ALSlipperyOil.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Surface hazard update"), STAT_ALSurfaceHazardUpdate, STATGROUP_ALCharacter);
+
+UALSurfaceHazardComponent::UALSurfaceHazardComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UALSurfaceHazardComponent::UpdateFloor(const FFindFloorResult& Floor)
+{
+	AL_SCOPE_CYCLE_COUNTER(STAT_ALSurfaceHazardUpdate);
+
+	const UPrimitiveComponent* FloorPrimitive = Floor.bBlockingHit ? Floor.HitResult.Component.Get() : nullptr;
+	if (FloorPrimitive == CurrentFloorPrimitive.Get())
+		return;
+
+	CurrentFloorPrimitive = FloorPrimitive;
+
+	if (FloorPrimitive == nullptr)
+	{
+		SetCurrentSurface(EALSurfaceType::None);
+		return;
+	}
+
+	EALSurfaceType* CachedSurface = SurfaceCache.Find(FloorPrimitive);
+	if (CachedSurface == nullptr)
+	{
+		// Drop primitives that have been destroyed since, so streaming levels don't grow the cache forever
+		if (SurfaceCache.Num() >= 256)
+		{
+			for (auto It = SurfaceCache.CreateIterator(); It; ++It)
+			{
+				if (!It.Key().IsValid())
+					It.RemoveCurrent();
+			}
+		}
+
+		CachedSurface = &SurfaceCache.Add(FloorPrimitive, ClassifyPrimitive(FloorPrimitive));
+	}
+
+	SetCurrentSurface(*CachedSurface);
+}
+
+void UALSurfaceHazardComponent::ClearFloor()
+{
+	CurrentFloorPrimitive = nullptr;
+	SetCurrentSurface(EALSurfaceType::None);
+}
+
+EALSurfaceType UALSurfaceHazardComponent::ClassifyPrimitive(const UPrimitiveComponent* Primitive) const
+{
+	if (const EALSurfaceType* ChannelSurface = ObjectChannelSurfaceTypes.Find(Primitive->GetCollisionObjectType()))
+		return *ChannelSurface;
+
+	// Floor sweeps don't return the physical material, so the primitive's own one is used. That's also what makes it cacheable.
+	if (const FBodyInstance* BodyInstance = Primitive->GetBodyInstance())
+	{
+		const EPhysicalSurface PhysicalSurface = UPhysicalMaterial::DetermineSurfaceType(BodyInstance->GetSimplePhysicalMaterial());
+		if (const EALSurfaceType* MaterialSurface = PhysicalSurfaceTypes.Find(PhysicalSurface))
+			return *MaterialSurface;
+	}
+
+	// Only runs once per primitive, the result is cached
+	if (DetectSlipperyOilComponents && Primitive->GetOwner() && Primitive->GetOwner()->FindComponentByClass<UALSlipperyOil>())
+		return EALSurfaceType::Oil;
+
+	return EALSurfaceType::None;
+}
+
+void UALSurfaceHazardComponent::SetCurrentSurface(EALSurfaceType NewSurface)
+{
+	if (NewSurface == CurrentSurface)
+		return;
+
+	const EALSurfaceType OldSurface = CurrentSurface;
+	CurrentSurface = NewSurface;
+
+	if (OldSurface != EALSurfaceType::None)
+		OnSurfaceExited.Broadcast(OldSurface);
+
+	if (NewSurface != EALSurfaceType::None)
+		OnSurfaceEntered.Broadcast(NewSurface);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/EngineTypes.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "ALSurfaceHazardComponent.generated.h"
+
+struct FFindFloorResult;
+
+UENUM(BlueprintType)
+enum class EALSurfaceType : uint8
+{
+	None,
+	Oil,
+	Ice,
+	Mud
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSurfaceHazard, EALSurfaceType, SurfaceType);
+
+// Works out what kind of surface the character is standing on from the floor the movement component has already found,
+// so no overlap volume or extra trace is needed. The result is cached per floor primitive and only transitions are reported.
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class UALSurfaceHazardComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UALSurfaceHazardComponent();
+
+	// Call with the movement component's CurrentFloor after it has moved. Does nothing while the floor primitive stays the same.
+	void UpdateFloor(const FFindFloorResult& Floor);
+
+	// Forgets the current surface, for example when the character leaves the ground
+	void ClearFloor();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	EALSurfaceType GetCurrentSurface() const { return CurrentSurface; }
+
+	UPROPERTY(BlueprintAssignable, meta = (ToolTip = "Happens when the character steps onto a hazardous surface"))
+	FOnSurfaceHazard OnSurfaceEntered;
+
+	UPROPERTY(BlueprintAssignable, meta = (ToolTip = "Happens when the character steps off a hazardous surface"))
+	FOnSurfaceHazard OnSurfaceExited;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Surface Hazards", meta = (ToolTip = "Surface type for floors using one of the physical surfaces set up in the project settings"))
+	TMap<TEnumAsByte<EPhysicalSurface>, EALSurfaceType> PhysicalSurfaceTypes;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Surface Hazards", meta = (ToolTip = "Surface type for floors using a dedicated collision object channel. Checked before the physical surfaces"))
+	TMap<TEnumAsByte<ECollisionChannel>, EALSurfaceType> ObjectChannelSurfaceTypes;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Surface Hazards", meta = (ToolTip = "Also treat any actor with a Slippery Oil component as oil, for levels that haven't been moved over to physical materials yet"))
+	bool DetectSlipperyOilComponents = true;
+
+private:
+
+	EALSurfaceType ClassifyPrimitive(const UPrimitiveComponent* Primitive) const;
+	void SetCurrentSurface(EALSurfaceType NewSurface);
+
+	TMap<TWeakObjectPtr<const UPrimitiveComponent>, EALSurfaceType> SurfaceCache;
+
+	TWeakObjectPtr<const UPrimitiveComponent> CurrentFloorPrimitive;
+	EALSurfaceType CurrentSurface = EALSurfaceType::None;
+};
@@ -0,0 +1,117 @@
+"""Reads the .altm telemetry files written by UALTelemetrySubsystem.
+
+    python ALTelemetry.py csv Saved/Telemetry/*.altm -o events.csv
+    python ALTelemetry.py heatmap Saved/Telemetry/*.altm --event Dash --cell 200 -o dash.pgm
+
+csv writes one row per event. heatmap counts events per grid cell on the X/Y plane and writes a greyscale PGM image,
+or a CSV grid of the counts when the output ends in .csv.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4D544C41  # "ALTM"
+VERSION = 1
+RECORD = struct.Struct("<fIfffB3x")
+
+# Same order as EALTelemetryEvent
+EVENTS = ["Jump", "DoubleJump", "Dash", "SlideStart", "SlideStop", "OilEnter", "OilExit", "ProjectileFire", "Push"]
+
+
+def read_records(path):
+    with open(path, "rb") as f:
+        magic, version, record_size = struct.unpack("<IHH", f.read(8))
+        if magic != MAGIC or version != VERSION or record_size != RECORD.size:
+            raise ValueError(f"{path} isn't a version {VERSION} telemetry file")
+
+        while True:
+            header = f.read(8)
+            if len(header) < 8:
+                return
+            count, compressed_size = struct.unpack("<II", header)
+            compressed = f.read(compressed_size)
+            if len(compressed) < compressed_size:
+                # The game was killed while writing the last chunk
+                return
+            data = zlib.decompress(compressed)
+            for i in range(count):
+                yield RECORD.unpack_from(data, i * RECORD.size)
+
+
+def event_name(event):
+    return EVENTS[event] if event < len(EVENTS) else f"Unknown{event}"
+
+
+def write_csv(paths, out):
+    writer = csv.writer(out)
+    writer.writerow(["file", "time", "source", "x", "y", "z", "event"])
+    for path in paths:
+        for time, source, x, y, z, event in read_records(path):
+            writer.writerow([path, f"{time:.3f}", source, f"{x:.1f}", f"{y:.1f}", f"{z:.1f}", event_name(event)])
+
+
+def write_heatmap(paths, event_filter, cell, output):
+    cells = {}
+    for path in paths:
+        for _, _, x, y, _, event in read_records(path):
+            if event_filter and event_name(event) != event_filter:
+                continue
+            key = (int(x // cell), int(y // cell))
+            cells[key] = cells.get(key, 0) + 1
+
+    if not cells:
+        sys.exit("No matching events")
+
+    min_x = min(k[0] for k in cells)
+    max_x = max(k[0] for k in cells)
+    min_y = min(k[1] for k in cells)
+    max_y = max(k[1] for k in cells)
+    width = max_x - min_x + 1
+    height = max_y - min_y + 1
+    peak = max(cells.values())
+
+    rows = [[cells.get((min_x + column, max_y - row), 0) for column in range(width)] for row in range(height)]
+
+    if output.endswith(".csv"):
+        with open(output, "w", newline="") as f:
+            csv.writer(f).writerows(rows)
+        return
+
+    with open(output, "wb") as f:
+        f.write(f"P5\n{width} {height}\n255\n".encode("ascii"))
+        f.write(bytes(255 * count // peak for row in rows for count in row))
+
+    print(f"{width}x{height} cells of {cell} units, starting at ({min_x * cell}, {min_y * cell}), peak {peak} events")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    csv_command = commands.add_parser("csv")
+    csv_command.add_argument("files", nargs="+")
+    csv_command.add_argument("-o", "--output")
+
+    heatmap_command = commands.add_parser("heatmap")
+    heatmap_command.add_argument("files", nargs="+")
+    heatmap_command.add_argument("--event", choices=EVENTS)
+    heatmap_command.add_argument("--cell", type=float, default=200.0)
+    heatmap_command.add_argument("-o", "--output", required=True)
+
+    args = parser.parse_args()
+
+    if args.command == "csv":
+        if args.output:
+            with open(args.output, "w", newline="") as out:
+                write_csv(args.files, out)
+        else:
+            write_csv(args.files, sys.stdout)
+    else:
+        write_heatmap(args.files, args.event, args.cell, args.output)
+
+
+if __name__ == "__main__":
+    main()